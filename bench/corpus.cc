@@ -0,0 +1,217 @@
+#include "corpus.h"
+
+#include <random>
+
+namespace tez::bench {
+
+namespace {
+
+const char* const BINARY_OPERATORS[]{
+        "+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^"};
+const char* const COMPARISONS[]{"<", ">", "<=", ">=", "==", "!="};
+const char* const TYPES[]{"Int", "Int64", "Double", "^Int", "^Char"};
+const char* const WORDS[]{
+        "the", "compiler", "token", "lexer", "parses", "every", "function",
+        "and", "emits", "code", "for", "each", "statement", "in", "file"};
+
+template<typename T, std::size_t N>
+constexpr std::size_t count(const T (&)[N]) { return N; }
+
+class Generator {
+public:
+    Generator(const Corpus_Shape& shape, std::uint32_t seed)
+            : _shape{shape}, _random{seed} {}
+
+    std::string generate(std::size_t size) {
+        const auto total = _shape.functions + _shape.structs + _shape.enums
+                + _shape.comments;
+        while(_out.size() < size) {
+            // std::uniform_int_distribution isn't the same in every standard
+            // library, plain modulo keeps output portable.
+            auto pick = _random() % total;
+            if(pick < _shape.functions) {
+                function();
+            } else if((pick -= _shape.functions) < _shape.structs) {
+                structure();
+            } else if((pick -= _shape.structs) < _shape.enums) {
+                enumeration();
+            } else {
+                comment();
+            }
+            _out += '\n';
+        }
+        _out += "func main() -> Int {\n    return 0;\n}\n";
+        return std::move(_out);
+    }
+
+private:
+    std::uint32_t below(std::uint32_t n) { return _random() % n; }
+
+    void function() {
+        const auto id = _functions++;
+        _out += "func f" + std::to_string(id) + "(a: Int, b: Int) -> Int {\n";
+        _variables = 0;
+        for(unsigned i = 0; i < _shape.statements; ++i) {
+            statement();
+        }
+        _out += "    return ";
+        expression(_shape.expression_depth);
+        _out += ";\n}\n";
+    }
+
+    void statement() {
+        switch(below(_variables == 0 ? 1 : 4)) {
+        case 0:
+            _out += "    var v" + std::to_string(_variables++) + ": Int = ";
+            expression(_shape.expression_depth);
+            _out += ";\n";
+            break;
+        case 1:
+            _out += "    v" + std::to_string(below(_variables)) + " = ";
+            expression(_shape.expression_depth);
+            _out += ";\n";
+            break;
+        case 2:
+            _out += "    if ";
+            condition();
+            _out += " {\n        v0 += ";
+            expression(_shape.expression_depth);
+            _out += ";\n    } else {\n        v0 = v0 - 1;\n    }\n";
+            break;
+        default:
+            _out += "    while ";
+            condition();
+            _out += " {\n        v0 = v0 / 2;\n    }\n";
+            break;
+        }
+    }
+
+    void condition() {
+        expression(1);
+        _out += ' ';
+        _out += COMPARISONS[below(count(COMPARISONS))];
+        _out += ' ';
+        expression(1);
+    }
+
+    void expression(unsigned depth) {
+        if(depth == 0) {
+            operand();
+            return;
+        }
+        const bool grouped = below(4) == 0;
+        if(grouped) {
+            _out += '(';
+        }
+        expression(depth - 1);
+        _out += ' ';
+        _out += BINARY_OPERATORS[below(count(BINARY_OPERATORS))];
+        _out += ' ';
+        expression(depth - 1);
+        if(grouped) {
+            _out += ')';
+        }
+    }
+
+    void operand() {
+        switch(below(_functions > 1 ? 5 : 4)) {
+        case 0:
+            _out += std::to_string(below(1000));
+            break;
+        case 1:
+            _out += below(2) == 0 ? 'a' : 'b';
+            break;
+        case 2:
+        case 3:
+            if(_variables > 0) {
+                _out += 'v' + std::to_string(below(_variables));
+            } else {
+                _out += 'a';
+            }
+            break;
+        default:    // Call of one of previous functions.
+            _out += 'f' + std::to_string(below(_functions - 1)) + "(a, "
+                    + std::to_string(below(100)) + ')';
+            break;
+        }
+    }
+
+    void structure() {
+        _out += "struct S" + std::to_string(_structs++) + " {\n";
+        for(unsigned i = 0; i < _shape.members; ++i) {
+            _out += "    m" + std::to_string(i) + ": ";
+            _out += TYPES[below(count(TYPES))];
+            _out += ";\n";
+        }
+        _out += "}\n";
+    }
+
+    void enumeration() {
+        const auto name = "E" + std::to_string(_enums++);
+        _out += "enum " + name + " {\n";
+        for(unsigned i = 0; i < _shape.members; ++i) {
+            _out += "    " + name + "_V" + std::to_string(i);
+            if(below(4) == 0) {
+                _out += " = " + std::to_string(i * 10);
+            }
+            _out += i + 1 < _shape.members ? ",\n" : "\n";
+        }
+        _out += "}\n";
+    }
+
+    void comment() {
+        const bool block = below(2) == 0;
+        if(block) {
+            _out += "/*\n";
+        }
+        for(unsigned i = 0; i < _shape.comment_lines; ++i) {
+            _out += block ? " *" : "//";
+            for(unsigned word = 0; word < 10; ++word) {
+                _out += ' ';
+                _out += WORDS[below(count(WORDS))];
+            }
+            _out += '\n';
+        }
+        if(block) {
+            _out += " */\n";
+        }
+    }
+
+    const Corpus_Shape& _shape;
+    std::mt19937        _random;
+    std::string         _out;
+
+    std::uint32_t _functions = 0;
+    std::uint32_t _structs = 0;
+    std::uint32_t _enums = 0;
+    std::uint32_t _variables = 0;   // Declared in current function.
+};
+
+}
+
+const std::vector<Corpus_Shape>& corpus_shapes() {
+    static const std::vector<Corpus_Shape> shapes{
+            {"functions",    1, 0, 0, 0, 6, 2, 6, 4},
+            {"expressions",  1, 0, 0, 0, 4, 7, 6, 4},
+            {"comments",     1, 0, 0, 4, 2, 1, 6, 16},
+            {"declarations", 0, 1, 1, 0, 6, 2, 64, 4},
+            {"mixed",        4, 1, 1, 1, 6, 3, 8, 4},
+    };
+    return shapes;
+}
+
+const Corpus_Shape* find_corpus_shape(std::string_view name) {
+    for(const auto& shape : corpus_shapes()) {
+        if(shape.name == name) {
+            return &shape;
+        }
+    }
+    return nullptr;
+}
+
+std::string generate_corpus(const Corpus_Shape& shape, std::size_t size,
+        std::uint32_t seed) {
+    return Generator{shape, seed}.generate(size);
+}
+
+}
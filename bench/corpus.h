@@ -0,0 +1,41 @@
+#ifndef TEZ_BENCH_CORPUS_H
+#define TEZ_BENCH_CORPUS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tez::bench {
+
+// Shape of generated program. Top level items are picked randomly, with
+// probability proportional to their weights.
+struct Corpus_Shape {
+    std::string name;
+
+    unsigned functions = 0;
+    unsigned structs = 0;
+    unsigned enums = 0;
+    unsigned comments = 0;
+
+    unsigned statements = 6;        // Per function.
+    unsigned expression_depth = 2;  // Levels of nested binary operations.
+    unsigned members = 6;           // Per struct and enum.
+    unsigned comment_lines = 4;     // Per comment.
+};
+
+// Predefined shapes: "functions", "expressions", "comments", "declarations"
+// and "mixed".
+const std::vector<Corpus_Shape>& corpus_shapes();
+// Returns nullptr if there is no such shape.
+const Corpus_Shape* find_corpus_shape(std::string_view name);
+
+// Generate valid Tez program of at least size bytes. Output depends only on
+// arguments, so results are comparable across runs and machines.
+std::string generate_corpus(const Corpus_Shape& shape, std::size_t size,
+        std::uint32_t seed = 1);
+
+}
+
+#endif //TEZ_BENCH_CORPUS_H
@@ -0,0 +1,28 @@
+// Print generated program to stdout, e.g. to profile tezc itself:
+//     tezc_corpus mixed 16777216 > big.tez
+
+#include <iostream>
+#include <string>
+
+#include "corpus.h"
+
+int main(int argc, char** argv) {
+    if(argc < 3 || argc > 4) {
+        std::cerr << "Usage: tezc_corpus shape size_in_bytes [seed]\nShapes:";
+        for(const auto& shape : tez::bench::corpus_shapes()) {
+            std::cerr << ' ' << shape.name;
+        }
+        std::cerr << '\n';
+        return 1;
+    }
+    const auto shape = tez::bench::find_corpus_shape(argv[1]);
+    if(shape == nullptr) {
+        std::cerr << "Error: unknown shape '" << argv[1] << "'.\n";
+        return 1;
+    }
+    const auto size = std::stoul(argv[2]);
+    const auto seed = argc == 4 ? std::stoul(argv[3]) : 1;
+    std::cout << tez::bench::generate_corpus(*shape, size,
+            static_cast<std::uint32_t>(seed));
+    return 0;
+}
@@ -0,0 +1,357 @@
+// Front end throughput on generated programs (see corpus.h). Reports MB/s and
+// tokens/s for lexing, nodes/s for parsing and flattening, bytes/s of C code
+// produced by generate_c and time of reparse after small edit. Run with
+// --benchmark_filter=<regex> to pick benchmarks.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "corpus.h"
+#include "codegen/c_codegen.h"
+#include "syntax/ast.h"
+#include "syntax/file_table.h"
+#include "syntax/flat_ast.h"
+#include "syntax/lexer.h"
+#include "syntax/parser.h"
+#include "utils/thread_pool.h"
+
+namespace {
+
+constexpr std::size_t CORPUS_SIZE = 4 * 1024 * 1024;
+
+// Generating corpus takes longer than lexing it, so every shape is generated
+// once and shared by all benchmarks.
+struct Corpus {
+    tez::File_Table files;
+    tez::File_Id    file;
+    std::size_t     size;
+};
+
+const Corpus& corpus(const std::string& shape_name) {
+    static std::vector<std::pair<std::string, std::unique_ptr<Corpus>>> cache;
+    for(const auto& [name, cached] : cache) {
+        if(name == shape_name) {
+            return *cached;
+        }
+    }
+    auto generated = std::make_unique<Corpus>();
+    const auto source = tez::bench::generate_corpus(
+            *tez::bench::find_corpus_shape(shape_name), CORPUS_SIZE);
+    generated->file = generated->files.add(shape_name + ".tez", source);
+    generated->size = source.size();
+    cache.emplace_back(shape_name, std::move(generated));
+    return *cache.back().second;
+}
+
+std::size_t count_nodes(const tez::Ast_Node* node);
+
+template<typename List>
+std::size_t count_list_nodes(const List& nodes) {
+    std::size_t count = 0;
+    for(const auto& node : nodes) {
+        count += count_nodes(static_cast<const tez::Ast_Node*>(node));
+    }
+    return count;
+}
+
+std::size_t count_nodes(const tez::Ast_Node* node) {
+    using namespace tez;
+    if(node == nullptr) {
+        return 0;
+    }
+    switch(node->node_type) {
+    case Ast_Node_Type::FILE:
+        return 1 + count_list_nodes(static_cast<const Ast_File*>(node)->statements);
+    case Ast_Node_Type::BLOCK:
+        return 1 + count_list_nodes(static_cast<const Ast_Block*>(node)->statements);
+    case Ast_Node_Type::NAMESPACE:
+        return 1 + count_nodes(&static_cast<const Ast_Namespace*>(node)->body);
+    case Ast_Node_Type::UNARY_OPERATION:
+        return 1 + count_nodes(
+                static_cast<const Ast_Unary_Operation*>(node)->left);
+    case Ast_Node_Type::BINARY_OPERATION: {
+        const auto op = static_cast<const Ast_Binary_Operation*>(node);
+        return 1 + count_nodes(op->left) + count_nodes(op->right);
+    }
+    case Ast_Node_Type::GROUPING_EXPRESSION:
+        return 1 + count_nodes(
+                static_cast<const Ast_Grouping_Expression*>(node)->expr);
+    case Ast_Node_Type::CAST: {
+        const auto cast = static_cast<const Ast_Cast*>(node);
+        return 1 + count_nodes(cast->expr) + count_nodes(cast->to);
+    }
+    case Ast_Node_Type::FUNCTION_DECLARATION: {
+        const auto func = static_cast<const Ast_Func_Decl*>(node);
+        std::size_t count = 1 + count_nodes(func->return_type)
+                + count_nodes(&func->body);
+        for(const auto& param : func->params) {
+            count += count_nodes(param.type);
+        }
+        return count;
+    }
+    case Ast_Node_Type::FUNCTION_CALL:
+        return 1 + count_list_nodes(static_cast<const Ast_Func_Call*>(node)->args);
+    case Ast_Node_Type::RETURN:
+        return 1 + count_nodes(static_cast<const Ast_Return*>(node)->expr);
+    case Ast_Node_Type::VARIABLE_DECLARATION: {
+        const auto var = static_cast<const Ast_Var_Decl*>(node);
+        return 1 + count_nodes(var->type)
+                + count_nodes(var->initializer);
+    }
+    case Ast_Node_Type::IF: {
+        const auto if_ = static_cast<const Ast_If*>(node);
+        return 1 + count_nodes(if_->condition)
+                + count_nodes(&if_->if_block)
+                + count_nodes(if_->else_block);
+    }
+    case Ast_Node_Type::WHILE: {
+        const auto loop = static_cast<const Ast_While*>(node);
+        return 1 + count_nodes(loop->condition)
+                + count_nodes(&loop->body);
+    }
+    case Ast_Node_Type::DO_WHILE: {
+        const auto loop = static_cast<const Ast_Do_While*>(node);
+        return 1 + count_nodes(loop->condition)
+                + count_nodes(&loop->body);
+    }
+    case Ast_Node_Type::FOR: {
+        const auto loop = static_cast<const Ast_For*>(node);
+        return 1 + count_nodes(loop->init_statement)
+                + count_nodes(loop->condition)
+                + count_nodes(loop->iteration_expr)
+                + count_nodes(&loop->body);
+    }
+    case Ast_Node_Type::STRUCT: {
+        std::size_t count = 1;
+        for(const auto& field : static_cast<const Ast_Struct*>(node)->fields) {
+            count += count_nodes(field.type);
+        }
+        return count;
+    }
+    case Ast_Node_Type::UNION: {
+        std::size_t count = 1;
+        for(const auto& member
+                : static_cast<const Ast_Union_Decl*>(node)->members) {
+            count += count_nodes(member.type);
+        }
+        return count;
+    }
+    case Ast_Node_Type::ARRAY_ACCESS: {
+        const auto access = static_cast<const Ast_Array_Access*>(node);
+        return 1 + count_nodes(access->array)
+                + count_nodes(access->at);
+    }
+    case Ast_Node_Type::MEMBER_ACCESS: {
+        const auto access = static_cast<const Ast_Member_Access*>(node);
+        return 1 + count_nodes(access->left)
+                + count_nodes(access->right);
+    }
+    case Ast_Node_Type::SCOPE_RESOLUTION: {
+        const auto scope = static_cast<const Ast_Scope_Resolution*>(node);
+        return 1 + count_nodes(scope->left)
+                + count_nodes(scope->right);
+    }
+    case Ast_Node_Type::PTR_DEREFERENCE:
+        return 1 + count_nodes(
+                static_cast<const Ast_Ptr_Dereference*>(node)->expr);
+    case Ast_Node_Type::ADDRESS_OF:
+        return 1 + count_nodes(
+                static_cast<const Ast_Address_Of*>(node)->expr);
+    case Ast_Node_Type::NEW:
+        return 1 + count_nodes(static_cast<const Ast_New*>(node)->type);
+    case Ast_Node_Type::FREE:
+        return 1 + count_nodes(static_cast<const Ast_Free*>(node)->what);
+    case Ast_Node_Type::ARRAY_INITIALIZER:
+        return 1 + count_list_nodes(
+                static_cast<const Ast_Array_Initializer*>(node)->values);
+    case Ast_Node_Type::POINTER:
+        return 1 + count_nodes(static_cast<const Ast_Pointer*>(node)->expr);
+    case Ast_Node_Type::ARRAY: {
+        const auto array = static_cast<const Ast_Array*>(node);
+        return 1 + count_nodes(array->type)
+                + count_nodes(array->size);
+    }
+    default:    // Leaves.
+        return 1;
+    }
+}
+
+void lex(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    std::size_t tokens = 0;
+    for(auto _ : state) {
+        tez::Lexer lexer{input.files, input.file, diagnostics};
+        auto output = lexer.tokenize();
+        benchmark::DoNotOptimize(output.data());
+        tokens = output.size();
+    }
+    state.SetBytesProcessed(state.iterations() * input.size);
+    state.counters["tokens/s"] = benchmark::Counter(
+            static_cast<double>(tokens * state.iterations()),
+            benchmark::Counter::kIsRate);
+}
+
+// Tokens are pulled one by one, like parser does, so storing them isn't
+// measured.
+void lex_stream(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    std::size_t tokens = 0;
+    for(auto _ : state) {
+        tez::Lexer lexer{input.files, input.file, diagnostics};
+        tokens = 0;
+        while(lexer.next().type != tez::Token_Type::END_OF_FILE) {
+            ++tokens;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * input.size);
+    state.counters["tokens/s"] = benchmark::Counter(
+            static_cast<double>(tokens * state.iterations()),
+            benchmark::Counter::kIsRate);
+}
+
+// Parsing of already tokenized file; AST destruction is included.
+void parse(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{input.files, input.file, diagnostics};
+    const auto tokens = lexer.tokenize();
+    std::size_t nodes = 0;
+    for(auto _ : state) {
+        tez::Parser parser{tokens, input.files, diagnostics};
+        auto ast = parser.parse();
+        if(nodes == 0) {
+            nodes = count_nodes(&ast);
+        }
+        benchmark::DoNotOptimize(ast.statements.data());
+    }
+    state.SetBytesProcessed(state.iterations() * input.size);
+    state.counters["nodes/s"] = benchmark::Counter(
+            static_cast<double>(nodes * state.iterations()),
+            benchmark::Counter::kIsRate);
+}
+
+// Bytes are these of generated C code, not of input.
+void generate_c(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{input.files, input.file, diagnostics};
+    tez::Parser parser{lexer, input.files, diagnostics};
+    const auto ast = parser.parse();
+    std::size_t output_size = 0;
+    for(auto _ : state) {
+        auto output = tez::generate_c(ast);
+        benchmark::DoNotOptimize(output.data());
+        output_size = output.size();
+    }
+    state.SetBytesProcessed(state.iterations() * output_size);
+}
+
+// Whole corpus file generated with pool of state.range(0) threads, wall time.
+void generate_c_parallel(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{input.files, input.file, diagnostics};
+    tez::Parser parser{lexer, input.files, diagnostics};
+    tez::Ast ast;
+    ast.push_back(parser.parse());
+    tez::Thread_Pool pool{static_cast<std::size_t>(state.range(0))};
+    std::size_t output_size = 0;
+    for(auto _ : state) {
+        tez::C_Writer output;
+        tez::generate_c(ast, output, pool);
+        benchmark::DoNotOptimize(output.str().data());
+        output_size = output.size();
+    }
+    state.SetBytesProcessed(state.iterations() * output_size);
+}
+
+// Conversion to Flat_Ast. Memory per node is reported for both forms; for
+// pointer AST it's size of arena, including unused space.
+void flatten(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{input.files, input.file, diagnostics};
+    tez::Parser parser{lexer, input.files, diagnostics};
+    const auto ast = parser.parse();
+    const auto nodes = count_nodes(&ast);
+    std::size_t flat_memory = 0;
+    for(auto _ : state) {
+        const auto flat = tez::flatten(ast);
+        benchmark::DoNotOptimize(flat.nodes.data());
+        flat_memory = flat.memory();
+    }
+    state.counters["nodes/s"] = benchmark::Counter(
+            static_cast<double>(nodes * state.iterations()),
+            benchmark::Counter::kIsRate);
+    state.counters["tree_bytes/node"] = static_cast<double>(
+            ast.arena->capacity()) / static_cast<double>(nodes);
+    state.counters["flat_bytes/node"] = static_cast<double>(flat_memory)
+            / static_cast<double>(nodes);
+}
+
+void generate_c_flat(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{input.files, input.file, diagnostics};
+    tez::Parser parser{lexer, input.files, diagnostics};
+    const auto flat = tez::flatten(parser.parse());
+    std::size_t output_size = 0;
+    for(auto _ : state) {
+        auto output = tez::generate_c(flat);
+        benchmark::DoNotOptimize(output.data());
+        output_size = output.size();
+    }
+    state.SetBytesProcessed(state.iterations() * output_size);
+}
+
+// Edit in the middle of file followed by incremental reparse. Every iteration
+// inserts one space and removes it again. Applying edit copies whole source,
+// that's included too.
+void reparse(benchmark::State& state, const std::string& shape) {
+    const auto& input = corpus(shape);
+    tez::File_Table files;
+    const auto file = files.add("edited.tez", input.files.source(input.file));
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, file, diagnostics};
+    auto ast = tez::Parser{lexer, files, diagnostics}.parse();
+    const auto offset = ast.ranges.at(ast.ranges.size() / 2).begin;
+    const tez::Text_Edit insert{offset, 0, " "};
+    const tez::Text_Edit remove{offset, 1, ""};
+    for(auto _ : state) {
+        files.edit(file, insert);
+        tez::Parser::reparse(ast, file, insert, files, diagnostics);
+        files.edit(file, remove);
+        tez::Parser::reparse(ast, file, remove, files, diagnostics);
+        benchmark::DoNotOptimize(ast.statements.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+}
+
+#define TEZ_FRONTEND_BENCHMARKS(shape)                                       \
+    BENCHMARK_CAPTURE(lex, shape, #shape)->Unit(benchmark::kMillisecond);     \
+    BENCHMARK_CAPTURE(lex_stream, shape, #shape)->Unit(benchmark::kMillisecond);\
+    BENCHMARK_CAPTURE(parse, shape, #shape)->Unit(benchmark::kMillisecond);   \
+    BENCHMARK_CAPTURE(generate_c, shape, #shape)->Unit(benchmark::kMillisecond);\
+    BENCHMARK_CAPTURE(flatten, shape, #shape)->Unit(benchmark::kMillisecond);  \
+    BENCHMARK_CAPTURE(generate_c_flat, shape, #shape)                         \
+            ->Unit(benchmark::kMillisecond);                                  \
+    BENCHMARK_CAPTURE(reparse, shape, #shape)->Unit(benchmark::kMicrosecond)
+
+TEZ_FRONTEND_BENCHMARKS(functions);
+TEZ_FRONTEND_BENCHMARKS(expressions);
+TEZ_FRONTEND_BENCHMARKS(comments);
+TEZ_FRONTEND_BENCHMARKS(declarations);
+TEZ_FRONTEND_BENCHMARKS(mixed);
+
+BENCHMARK_CAPTURE(generate_c_parallel, mixed, "mixed")
+        ->RangeMultiplier(2)->Range(1, 8)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
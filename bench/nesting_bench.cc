@@ -0,0 +1,115 @@
+// Deeply nested input, like machine-generated code may contain: operator
+// chains, parentheses, prefix operators and "else if" chains with up to 1M
+// levels. Every iteration lexes, parses and generates C code on a thread with
+// small stack, so any recursion proportional to nesting crashes the benchmark.
+// Work is done on the other thread, so wall time is measured. Reported
+// complexity should be O(N).
+
+#include <pthread.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "codegen/c_codegen.h"
+#include "syntax/ast.h"
+#include "syntax/file_table.h"
+#include "syntax/lexer.h"
+#include "syntax/parser.h"
+
+namespace {
+
+constexpr std::size_t STACK_SIZE = 256 * 1024;
+
+template<typename Function>
+void run_with_small_stack(Function& function) {
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, STACK_SIZE);
+    pthread_t thread;
+    const auto error = pthread_create(&thread, &attributes, [](void* f) -> void* {
+        (*static_cast<Function*>(f))();
+        return nullptr;
+    }, &function);
+    pthread_attr_destroy(&attributes);
+    if(error != 0) {
+        throw std::runtime_error{"Failed to create thread."};
+    }
+    pthread_join(thread, nullptr);
+}
+
+std::string in_function(const std::string& body) {
+    return "func f(a: Int) -> Int {\n" + body + "\n}\n";
+}
+
+std::string repeat(const std::string& text, std::size_t count) {
+    std::string result;
+    result.reserve(text.size() * count);
+    for(std::size_t i = 0; i < count; ++i) {
+        result += text;
+    }
+    return result;
+}
+
+// Left associative chain: a + a * a - a * a + ...
+std::string operator_chain(std::size_t terms) {
+    return in_function("return a" + repeat(" + a * a - a", terms / 3) + ";");
+}
+
+// Right associative chain: a = a = ... = a
+std::string assignment_chain(std::size_t terms) {
+    return in_function(repeat("a = ", terms) + "a;");
+}
+
+std::string parentheses(std::size_t depth) {
+    return in_function("return " + repeat("(", depth) + "a"
+            + repeat(")", depth) + ";");
+}
+
+std::string prefix_operators(std::size_t depth) {
+    return in_function("return " + repeat("- !", depth / 2) + "a;");
+}
+
+std::string else_if_chain(std::size_t length) {
+    return in_function("if a == 0 { return 0; }"
+            + repeat(" else if a == 1 { return 1; }", length) + "\nreturn a;");
+}
+
+void nesting(benchmark::State& state, std::string (*generate)(std::size_t)) {
+    const auto size = static_cast<std::size_t>(state.range(0));
+    tez::File_Table files;
+    const auto file = files.add("nested.tez", generate(size));
+    bool failed = false;
+    auto compile = [&files, file, &failed] {
+        tez::Diagnostics diagnostics;
+        tez::Lexer lexer{files, file, diagnostics};
+        tez::Parser parser{lexer, files, diagnostics};
+        const auto ast = parser.parse();
+        const auto code = tez::generate_c(ast);
+        benchmark::DoNotOptimize(code.data());
+        failed = parser.errors_reported();
+    };
+    for(auto _ : state) {
+        run_with_small_stack(compile);
+    }
+    if(failed) {
+        state.SkipWithError("Generated code has syntax errors.");
+    }
+    state.SetComplexityN(state.range(0));
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+}
+
+#define TEZ_NESTING_BENCHMARK(generator)                                      \
+    BENCHMARK_CAPTURE(nesting, generator, generator)                          \
+            ->RangeMultiplier(4)->Range(1 << 12, 1 << 20)                     \
+            ->Unit(benchmark::kMillisecond)->UseRealTime()                    \
+            ->Complexity(benchmark::oN)
+
+TEZ_NESTING_BENCHMARK(operator_chain);
+TEZ_NESTING_BENCHMARK(assignment_chain);
+TEZ_NESTING_BENCHMARK(parentheses);
+TEZ_NESTING_BENCHMARK(prefix_operators);
+TEZ_NESTING_BENCHMARK(else_if_chain);
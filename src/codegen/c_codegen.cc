@@ -0,0 +1,987 @@
+#include "c_codegen.h"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <unordered_set>
+
+#include "syntax/ast_visitor.h"
+#include "utils/thread_pool.h"
+
+namespace tez {
+
+const std::string_view C_PRELUDE =
+        "#include<stdio.h>\n"
+        "#include<stdlib.h>\n"
+        "#include<stdint.h>\n"
+        "typedef void     Void;\n"
+        "typedef char     Bool;\n"
+        "typedef char     Char;\n"
+        "typedef int      Int;\n"
+        "typedef unsigned int Uint;\n"
+        "typedef int8_t   Int8;\n"
+        "typedef int16_t  Int16;\n"
+        "typedef int32_t  Int32;\n"
+        "typedef int64_t  Int64;\n"
+        "typedef uint8_t  Uint8;\n"
+        "typedef uint16_t Uint16;\n"
+        "typedef uint32_t Uint32;\n"
+        "typedef uint64_t Uint64;\n"
+        "typedef float    Float;\n"
+        "typedef double   Double;\n";
+
+namespace {
+
+bool needs_semicolon(Ast_Node_Type type) {
+    return type != Ast_Node_Type::BLOCK
+            && type != Ast_Node_Type::NAMESPACE
+            && type != Ast_Node_Type::FUNCTION_DECLARATION
+            && type != Ast_Node_Type::IF
+            && type != Ast_Node_Type::WHILE
+            && type != Ast_Node_Type::FOR;
+}
+
+// Whole statement goes to header of sharded output.
+bool is_type_declaration(Ast_Node_Type type) {
+    return type == Ast_Node_Type::STRUCT
+            || type == Ast_Node_Type::ENUM
+            || type == Ast_Node_Type::UNION;
+}
+
+// Bytes of source taken by i-th statement of file, 1 if unknown.
+std::size_t statement_size(const Ast_File& file, std::size_t i) {
+    if(file.ranges.size() != file.statements.size()) {
+        return 1;
+    }
+    return file.ranges[i].end - file.ranges[i].begin;
+}
+
+class C_Generator final : public Ast_Visitor<C_Generator, void> {
+public:
+    explicit C_Generator(C_Writer& out) : _out{out} {}
+
+    void visit_node(const Ast_File& node);
+    void visit_node(const Ast_Block& node);
+    void visit_node(const Ast_Boolean& node);
+    void visit_node(const Ast_Integer& node);
+    void visit_node(const Ast_Real_Number& node);
+    void visit_node(const Ast_String& node);
+    void visit_node(const Ast_Identifier& node);
+    void visit_node(const Ast_Unary_Operation& node);
+    void visit_node(const Ast_Binary_Operation& node);
+    void visit_node(const Ast_Grouping_Expression& node);
+    void visit_node(const Ast_Cast& node);
+    void visit_node(const Ast_Address_Of& node);
+    void visit_node(const Ast_Func_Decl& node);
+    void visit_node(const Ast_Return& node);
+    void visit_node(const Ast_Func_Call& node);
+    void visit_node(const Ast_Var_Decl& node);
+    void visit_node(const Ast_If& node);
+    void visit_node(const Ast_While& node);
+    void visit_node(const Ast_Do_While& node);
+    void visit_node(const Ast_For& node);
+    void visit_node(const Ast_Break& node);
+    void visit_node(const Ast_Continue& node);
+    void visit_node(const Ast_Struct& node);
+    void visit_node(const Ast_Enum& node);
+    void visit_node(const Ast_Union_Decl& node);
+    void visit_node(const Ast_Array_Access& node);
+    void visit_node(const Ast_Member_Access& node);
+    void visit_node(const Ast_Ptr_Dereference& node);
+    void visit_node(const Ast_New& node);
+    void visit_node(const Ast_Free& node);
+    void visit_node(const Ast_Null& node);
+    void visit_node(const Ast_Array_Initializer& node);
+    void visit_node(const Ast_Pointer& node);
+    void visit_node(const Ast_Array& node);
+    void visit_node(const Ast_Inline_Asm& node);
+    // Namespaces, usings and scope resolutions aren't generated yet.
+    void visit_node([[maybe_unused]] const Ast_Node& node) {}
+
+    void statement(const Ast_Node& node);
+    // Declarations for header of sharded output.
+    void prototype(const Ast_Func_Decl& node);
+    void extern_declaration(const Ast_Var_Decl& node);
+
+private:
+    void array_suffix(const Ast_Node& type);
+    void expression(const Ast_Node& root);
+    template<typename Members>
+    void members(std::string_view kind, Atom name, const Members& members);
+
+    C_Writer& _out;
+};
+
+void C_Generator::statement(const Ast_Node& node) {
+    _out.write_indent();
+    visit(node);
+    if(needs_semicolon(node.node_type)) {
+        _out.write(';');
+    }
+    _out.write('\n');
+}
+
+// Array dimensions of type, C writes them after name of variable.
+void C_Generator::array_suffix(const Ast_Node& type) {
+    if(type.node_type == Ast_Node_Type::POINTER) {
+        array_suffix(*node_cast<Ast_Pointer>(type).expr);
+    }
+    if(type.node_type == Ast_Node_Type::ARRAY) {
+        const auto& array = node_cast<Ast_Array>(type);
+        _out.write('[');
+        if(array.size != nullptr) {
+            visit(*array.size);
+        }
+        _out.write(']');
+        array_suffix(*array.type);
+    }
+}
+
+// Operators and parentheses are written with explicit stack instead of
+// recursion, generated expressions may be nested millions levels deep. Every
+// item is either node to print or text.
+void C_Generator::expression(const Ast_Node& root) {
+    struct Item {
+        const Ast_Node*  node;
+        std::string_view text;
+    };
+    std::vector<Item> stack{{&root, {}}};
+    while(!stack.empty()) {
+        const auto item = stack.back();
+        stack.pop_back();
+        if(item.node == nullptr) {
+            _out.write(item.text);
+            continue;
+        }
+        // Pushed in reverse order.
+        switch(item.node->node_type) {
+        case Ast_Node_Type::BINARY_OPERATION: {
+            const auto& op = node_cast<Ast_Binary_Operation>(*item.node);
+            stack.insert(stack.end(), {{op.right, {}}, {nullptr, " "}, {nullptr, spelling(op.operat)},
+                    {nullptr, " "}, {op.left, {}}});
+            break;
+        }
+        case Ast_Node_Type::UNARY_OPERATION: {
+            const auto& op = node_cast<Ast_Unary_Operation>(*item.node);
+            stack.insert(stack.end(), {{op.left, {}}, {nullptr, spelling(op.operat)}});
+            break;
+        }
+        case Ast_Node_Type::GROUPING_EXPRESSION: {
+            const auto& group = node_cast<Ast_Grouping_Expression>(*item.node);
+            stack.insert(stack.end(), {{nullptr, ")"}, {group.expr, {}}, {nullptr, "("}});
+            break;
+        }
+        case Ast_Node_Type::ADDRESS_OF: {
+            const auto& ao = node_cast<Ast_Address_Of>(*item.node);
+            stack.insert(stack.end(), {{ao.expr, {}}, {nullptr, "&"}});
+            break;
+        }
+        case Ast_Node_Type::PTR_DEREFERENCE: {
+            const auto& deref = node_cast<Ast_Ptr_Dereference>(*item.node);
+            stack.insert(stack.end(), {{nullptr, ")"}, {deref.expr, {}}, {nullptr, "(*"}});
+            break;
+        }
+        default:
+            visit(*item.node);
+        }
+    }
+}
+
+template<typename Members>
+void C_Generator::members(std::string_view kind, Atom name, const Members& members) {
+    _out.write("typedef ").write(kind).write(" {\n");
+    _out.indent();
+    for(const auto& member : members) {
+        _out.write_indent();
+        visit(*member.type);
+        _out.write(' ').write(member.name);
+        array_suffix(*member.type);
+        _out.write(";\n");
+    }
+    _out.dedent();
+    _out.write("} ").write(name);
+}
+
+void C_Generator::visit_node(const Ast_File& node) {
+    for(const auto& stmt : node.statements) {
+        statement(*stmt);
+    }
+}
+
+void C_Generator::visit_node(const Ast_Block& node) {
+    _out.write(" {\n");
+    _out.indent();
+    for(const auto& stmt : node.statements) {
+        statement(*stmt);
+    }
+    _out.dedent();
+    _out.write_indent().write('}');
+}
+
+void C_Generator::visit_node(const Ast_Boolean& node) {
+    _out.write(node.value ? '1' : '0');
+}
+
+void C_Generator::visit_node(const Ast_Integer& node) {
+    _out.write_integer(node.value);
+}
+
+void C_Generator::visit_node(const Ast_Real_Number& node) {
+    _out.write_real(node.value);
+}
+
+void C_Generator::visit_node(const Ast_String& node) {
+    _out.write('"').write(node.value).write('"');
+}
+
+void C_Generator::visit_node(const Ast_Identifier& node) {
+    _out.write(node.name);
+}
+
+void C_Generator::visit_node(const Ast_Unary_Operation& node) {
+    expression(node);
+}
+
+void C_Generator::visit_node(const Ast_Binary_Operation& node) {
+    expression(node);
+}
+
+void C_Generator::visit_node(const Ast_Grouping_Expression& node) {
+    expression(node);
+}
+
+void C_Generator::visit_node(const Ast_Cast& node) {
+    _out.write('(');
+    visit(*node.to);
+    _out.write(')');
+    visit(*node.expr);
+}
+
+void C_Generator::visit_node(const Ast_Address_Of& node) {
+    expression(node);
+}
+
+void C_Generator::prototype(const Ast_Func_Decl& node) {
+    visit(*node.return_type);
+    _out.write(' ').write(node.name).write('(');
+    for(std::size_t i = 0; i < node.params.size(); ++i) {
+        const auto& param = node.params[i];
+        visit(*param.type);
+        _out.write(' ').write(param.name);
+        if(i < node.params.size() - 1) {
+            _out.write(", ");
+        }
+    }
+    _out.write(')');
+}
+
+void C_Generator::extern_declaration(const Ast_Var_Decl& node) {
+    _out.write("extern ");
+    if(node.constant) {
+        _out.write("const ");
+    }
+    visit(*node.type);
+    _out.write(' ').write(node.name);
+    array_suffix(*node.type);
+}
+
+void C_Generator::visit_node(const Ast_Func_Decl& node) {
+    prototype(node);
+    visit_node(node.body);
+}
+
+void C_Generator::visit_node(const Ast_Return& node) {
+    _out.write("return ");
+    visit(*node.expr);
+}
+
+void C_Generator::visit_node(const Ast_Func_Call& node) {
+    _out.write(node.name).write('(');
+    for(std::size_t i = 0; i < node.args.size(); ++i) {
+        visit(*node.args[i]);
+        if(i < node.args.size() - 1) {
+            _out.write(", ");
+        }
+    }
+    _out.write(')');
+}
+
+void C_Generator::visit_node(const Ast_Var_Decl& node) {
+    if(node.constant) {
+        _out.write("const ");
+    }
+    visit(*node.type);
+    _out.write(' ').write(node.name);
+    array_suffix(*node.type);
+    if(node.initializer != nullptr) {
+        _out.write(" = ");
+        visit(*node.initializer);
+    }
+}
+
+void C_Generator::visit_node(const Ast_If& node) {
+    // "else if" chains are walked in loop, they may be very long.
+    auto current = &node;
+    while(true) {
+        _out.write("if(");
+        visit(*current->condition);
+        _out.write(')');
+        visit_node(current->if_block);
+        if(current->else_block == nullptr) {
+            break;
+        }
+        if(current->else_block->node_type != Ast_Node_Type::IF) {
+            _out.write(" else");
+            visit(*current->else_block);
+            break;
+        }
+        _out.write(" else ");
+        current = &node_cast<Ast_If>(*current->else_block);
+    }
+}
+
+void C_Generator::visit_node(const Ast_While& node) {
+    _out.write("while(");
+    visit(*node.condition);
+    _out.write(')');
+    visit_node(node.body);
+}
+
+void C_Generator::visit_node(const Ast_Do_While& node) {
+    _out.write("do");
+    visit_node(node.body);
+    _out.write(" while(");
+    visit(*node.condition);
+    _out.write(')');
+}
+
+void C_Generator::visit_node(const Ast_For& node) {
+    _out.write("for(");
+    visit(*node.init_statement);
+    _out.write("; ");
+    visit(*node.condition);
+    _out.write("; ");
+    visit(*node.iteration_expr);
+    _out.write(')');
+    visit_node(node.body);
+}
+
+void C_Generator::visit_node([[maybe_unused]] const Ast_Break& node) {
+    _out.write("break");
+}
+
+void C_Generator::visit_node([[maybe_unused]] const Ast_Continue& node) {
+    _out.write("continue");
+}
+
+void C_Generator::visit_node(const Ast_Struct& node) {
+    members("struct", node.name, node.fields);
+}
+
+void C_Generator::visit_node(const Ast_Enum& node) {
+    _out.write("typedef enum {\n");
+    _out.indent();
+    for(const auto& en : node.enumerations) {
+        _out.write_indent().write(en.name).write(" = ").write_integer(en.value).write(";\n");
+    }
+    _out.dedent();
+    _out.write("} ").write(node.name);
+}
+
+void C_Generator::visit_node(const Ast_Union_Decl& node) {
+    members("union", node.name, node.members);
+}
+
+void C_Generator::visit_node(const Ast_Array_Access& node) {
+    visit(*node.array);
+    _out.write('[');
+    visit(*node.at);
+    _out.write(']');
+}
+
+void C_Generator::visit_node(const Ast_Member_Access& node) {
+    visit(*node.left);
+    _out.write('.');
+    visit(*node.right);
+}
+
+void C_Generator::visit_node(const Ast_Ptr_Dereference& node) {
+    expression(node);
+}
+
+void C_Generator::visit_node(const Ast_New& node) {
+    _out.write("malloc(sizeof(");
+    visit(*node.type);
+    _out.write(')');
+}
+
+void C_Generator::visit_node(const Ast_Free& node) {
+    _out.write("free(");
+    visit(*node.what);
+    _out.write(')');
+}
+
+void C_Generator::visit_node([[maybe_unused]] const Ast_Null& node) {
+    _out.write("NULL");
+}
+
+void C_Generator::visit_node(const Ast_Array_Initializer& node) {
+    _out.write('{');
+    for(const auto& value : node.values) {
+        visit(*value);
+        _out.write(", ");
+    }
+    _out.write('}');
+}
+
+void C_Generator::visit_node(const Ast_Pointer& node) {
+    visit(*node.expr);
+    _out.write('*');
+}
+
+void C_Generator::visit_node(const Ast_Array& node) {
+    visit(*node.type);
+}
+
+void C_Generator::visit_node(const Ast_Inline_Asm& node) {
+    _out.write("asm(\n");
+    _out.indent();
+    for(const auto& op : node.operations) {
+        _out.write_indent().write('"').write(op).write("\"\n");
+    }
+    _out.dedent();
+    _out.write_indent().write(')');
+}
+
+// Generator for Flat_Ast, produces the same code as C_Generator.
+class Flat_C_Generator final {
+public:
+    Flat_C_Generator(const Flat_Ast& ast, C_Writer& out) : _ast{ast}, _out{out} {}
+
+    void node(Node_Index index);
+
+private:
+    void statement(Node_Index index);
+    void array_suffix(Node_Index type);
+    void expression(Node_Index root);
+    void members(std::string_view kind, const Flat_Node& node);
+
+    const Flat_Ast& _ast;
+    C_Writer&       _out;
+};
+
+void Flat_C_Generator::statement(Node_Index index) {
+    _out.write_indent();
+    node(index);
+    if(needs_semicolon(index == NO_NODE ? Ast_Node_Type::UNDEFINED : _ast[index].type)) {
+        _out.write(';');
+    }
+    _out.write('\n');
+}
+
+void Flat_C_Generator::array_suffix(Node_Index type) {
+    if(type == NO_NODE) {
+        return;
+    }
+    const auto& node = _ast[type];
+    if(node.type == Ast_Node_Type::POINTER) {
+        array_suffix(node.data[0]);
+    }
+    if(node.type == Ast_Node_Type::ARRAY) {
+        _out.write('[');
+        this->node(node.data[1]);
+        _out.write(']');
+        array_suffix(node.data[0]);
+    }
+}
+
+void Flat_C_Generator::expression(Node_Index root) {
+    struct Item {
+        Node_Index       node;      // NO_NODE for text.
+        std::string_view text;
+    };
+    std::vector<Item> stack{{root, {}}};
+    while(!stack.empty()) {
+        const auto item = stack.back();
+        stack.pop_back();
+        if(item.node == NO_NODE) {
+            _out.write(item.text);
+            continue;
+        }
+        // Pushed in reverse order.
+        const auto& node = _ast[item.node];
+        switch(node.type) {
+        case Ast_Node_Type::BINARY_OPERATION: {
+            const auto op = spelling(static_cast<Operator>(node.flags));
+            stack.insert(stack.end(), {{node.data[1], {}}, {NO_NODE, " "}, {NO_NODE, op}, {NO_NODE, " "},
+                    {node.data[0], {}}});
+            break;
+        }
+        case Ast_Node_Type::UNARY_OPERATION:
+            stack.insert(stack.end(), {{node.data[0], {}}, {NO_NODE, spelling(static_cast<Operator>(node.flags))}});
+            break;
+        case Ast_Node_Type::GROUPING_EXPRESSION:
+            stack.insert(stack.end(), {{NO_NODE, ")"}, {node.data[0], {}}, {NO_NODE, "("}});
+            break;
+        case Ast_Node_Type::ADDRESS_OF:
+            stack.insert(stack.end(), {{node.data[0], {}}, {NO_NODE, "&"}});
+            break;
+        case Ast_Node_Type::PTR_DEREFERENCE:
+            stack.insert(stack.end(), {{NO_NODE, ")"}, {node.data[0], {}}, {NO_NODE, "(*"}});
+            break;
+        default:
+            this->node(item.node);
+        }
+    }
+}
+
+void Flat_C_Generator::members(std::string_view kind, const Flat_Node& node) {
+    _out.write("typedef ").write(kind).write(" {\n");
+    _out.indent();
+    const auto members = _ast.list(node.data[1]);
+    for(std::uint32_t i = 0; i < node.data[2]; ++i) {
+        const auto& member = _ast[members[i]];
+        _out.write_indent();
+        if(node.type == Ast_Node_Type::ENUM) {
+            _out.write(_ast.text(member.data[0])).write(" = ").write_integer(_ast.integer(_ast[member.data[2]]));
+        } else {
+            this->node(member.data[1]);
+            _out.write(' ').write(_ast.text(member.data[0]));
+            array_suffix(member.data[1]);
+        }
+        _out.write(";\n");
+    }
+    _out.dedent();
+    _out.write("} ").write(_ast.text(node.data[0]));
+}
+
+void Flat_C_Generator::node(Node_Index index) {
+    if(index == NO_NODE) {
+        return;
+    }
+    const auto& node = _ast[index];
+    const auto list = _ast.list(node.data[0]);
+    switch(node.type) {
+    case Ast_Node_Type::FILE:
+        for(std::uint32_t i = 0; i < node.data[1]; ++i) {
+            statement(list[i]);
+        }
+        break;
+    case Ast_Node_Type::BLOCK:
+        _out.write(" {\n");
+        _out.indent();
+        for(std::uint32_t i = 0; i < node.data[1]; ++i) {
+            statement(list[i]);
+        }
+        _out.dedent();
+        _out.write_indent().write('}');
+        break;
+    case Ast_Node_Type::BOOLEAN:
+        _out.write(node.flags ? '1' : '0');
+        break;
+    case Ast_Node_Type::INTEGER:
+        _out.write_integer(_ast.integer(node));
+        break;
+    case Ast_Node_Type::REAL_NUMBER:
+        _out.write_real(_ast.real_number(node));
+        break;
+    case Ast_Node_Type::STRING:
+        _out.write('"').write(_ast.text(node.data[0])).write('"');
+        break;
+    case Ast_Node_Type::IDENTIFIER:
+        _out.write(_ast.text(node.data[0]));
+        break;
+    case Ast_Node_Type::UNARY_OPERATION:
+    case Ast_Node_Type::BINARY_OPERATION:
+    case Ast_Node_Type::GROUPING_EXPRESSION:
+    case Ast_Node_Type::ADDRESS_OF:
+    case Ast_Node_Type::PTR_DEREFERENCE:
+        expression(index);
+        break;
+    case Ast_Node_Type::CAST:
+        _out.write('(');
+        this->node(node.data[1]);
+        _out.write(')');
+        this->node(node.data[0]);
+        break;
+    case Ast_Node_Type::FUNCTION_DECLARATION: {
+        // List: parent, return type, body, parameters.
+        const auto decl = _ast.list(node.data[1]);
+        this->node(decl[1]);
+        _out.write(' ').write(_ast.text(node.data[0])).write('(');
+        for(std::uint32_t i = 3; i < node.data[2]; ++i) {
+            const auto& param = _ast[decl[i]];
+            this->node(param.data[1]);
+            _out.write(' ').write(_ast.text(param.data[0]));
+            if(i < node.data[2] - 1) {
+                _out.write(", ");
+            }
+        }
+        _out.write(')');
+        this->node(decl[2]);
+        break;
+    }
+    case Ast_Node_Type::RETURN:
+        _out.write("return ");
+        this->node(node.data[0]);
+        break;
+    case Ast_Node_Type::FUNCTION_CALL: {
+        const auto args = _ast.list(node.data[1]);
+        _out.write(_ast.text(node.data[0])).write('(');
+        for(std::uint32_t i = 0; i < node.data[2]; ++i) {
+            this->node(args[i]);
+            if(i < node.data[2] - 1) {
+                _out.write(", ");
+            }
+        }
+        _out.write(')');
+        break;
+    }
+    case Ast_Node_Type::VARIABLE_DECLARATION:
+        if(node.flags) {
+            _out.write("const ");
+        }
+        this->node(node.data[1]);
+        _out.write(' ').write(_ast.text(node.data[0]));
+        array_suffix(node.data[1]);
+        if(node.data[2] != NO_NODE) {
+            _out.write(" = ");
+            this->node(node.data[2]);
+        }
+        break;
+    case Ast_Node_Type::IF: {
+        // "else if" chains are walked in loop, they may be very long.
+        auto current = &node;
+        while(true) {
+            _out.write("if(");
+            this->node(current->data[0]);
+            _out.write(')');
+            this->node(current->data[1]);
+            const auto else_block = current->data[2];
+            if(else_block == NO_NODE) {
+                break;
+            }
+            if(_ast[else_block].type != Ast_Node_Type::IF) {
+                _out.write(" else");
+                this->node(else_block);
+                break;
+            }
+            _out.write(" else ");
+            current = &_ast[else_block];
+        }
+        break;
+    }
+    case Ast_Node_Type::WHILE:
+        _out.write("while(");
+        this->node(node.data[0]);
+        _out.write(')');
+        this->node(node.data[1]);
+        break;
+    case Ast_Node_Type::DO_WHILE:
+        _out.write("do");
+        this->node(node.data[1]);
+        _out.write(" while(");
+        this->node(node.data[0]);
+        _out.write(')');
+        break;
+    case Ast_Node_Type::FOR:
+        // List: init statement, condition, iteration expression, body.
+        _out.write("for(");
+        this->node(list[0]);
+        _out.write("; ");
+        this->node(list[1]);
+        _out.write("; ");
+        this->node(list[2]);
+        _out.write(')');
+        this->node(list[3]);
+        break;
+    case Ast_Node_Type::BREAK:
+        _out.write("break");
+        break;
+    case Ast_Node_Type::CONTINUE:
+        _out.write("continue");
+        break;
+    case Ast_Node_Type::STRUCT:
+        members("struct", node);
+        break;
+    case Ast_Node_Type::ENUM:
+        members("enum", node);
+        break;
+    case Ast_Node_Type::UNION:
+        members("union", node);
+        break;
+    case Ast_Node_Type::ARRAY_ACCESS:
+        this->node(node.data[0]);
+        _out.write('[');
+        this->node(node.data[1]);
+        _out.write(']');
+        break;
+    case Ast_Node_Type::MEMBER_ACCESS:
+        this->node(node.data[0]);
+        _out.write('.');
+        this->node(node.data[1]);
+        break;
+    case Ast_Node_Type::NEW:
+        _out.write("malloc(sizeof(");
+        this->node(node.data[0]);
+        _out.write(')');
+        break;
+    case Ast_Node_Type::FREE:
+        _out.write("free(");
+        this->node(node.data[0]);
+        _out.write(')');
+        break;
+    case Ast_Node_Type::NULL_:
+        _out.write("NULL");
+        break;
+    case Ast_Node_Type::ARRAY_INITIALIZER:
+        _out.write('{');
+        for(std::uint32_t i = 0; i < node.data[1]; ++i) {
+            this->node(list[i]);
+            _out.write(", ");
+        }
+        _out.write('}');
+        break;
+    case Ast_Node_Type::POINTER:
+        this->node(node.data[0]);
+        _out.write('*');
+        break;
+    case Ast_Node_Type::ARRAY:
+        this->node(node.data[0]);
+        break;
+    case Ast_Node_Type::INLINE_ASM:
+        _out.write("asm(\n");
+        _out.indent();
+        for(std::uint32_t i = 0; i < node.data[1]; ++i) {
+            _out.write_indent().write('"').write(_ast.text(list[i])).write("\"\n");
+        }
+        _out.dedent();
+        _out.write_indent().write(')');
+        break;
+    default:
+        // Namespaces, usings and scope resolutions aren't generated yet.
+        break;
+    }
+}
+
+}
+
+void generate_c(const Ast_Node& node, C_Writer& out) {
+    C_Generator{out}.visit(node);
+}
+
+void generate_c(const Flat_Ast& ast, C_Writer& out) {
+    Flat_C_Generator{ast, out}.node(ast.root);
+}
+
+void generate_c(const Ast& ast, C_Writer& out, Thread_Pool& pool) {
+    if(pool.size() < 2) {
+        for(const auto& file : ast) {
+            generate_c(file, out);
+            out.write('\n');
+        }
+        return;
+    }
+    // Consecutive statements of one file, generated by one task. Tasks get
+    // about TASK_SIZE bytes of source each, so small functions don't drown in
+    // scheduling and large ones are spread over all threads.
+    struct Task {
+        const Ast_File* file;
+        std::size_t     begin;
+        std::size_t     end;
+        bool            last;   // Ends file.
+    };
+    constexpr std::size_t TASK_SIZE = 16 * 1024;
+    std::vector<Task> tasks;
+    for(const auto& file : ast) {
+        const auto sizes_known = file.ranges.size() == file.statements.size();
+        std::size_t begin = 0;
+        std::size_t size = 0;
+        for(std::size_t i = 0; i < file.statements.size(); ++i) {
+            size += sizes_known ? file.ranges[i].end - file.ranges[i].begin : TASK_SIZE / 16;
+            if(size >= TASK_SIZE) {
+                tasks.push_back({&file, begin, i + 1, false});
+                begin = i + 1;
+                size = 0;
+            }
+        }
+        tasks.push_back({&file, begin, file.statements.size(), true});
+    }
+    // Tasks run in windows, so only few buffers wait for their turn to be
+    // written out.
+    const auto window = pool.size() * 8;
+    for(std::size_t first = 0; first < tasks.size(); first += window) {
+        const auto last = std::min(first + window, tasks.size());
+        std::deque<C_Writer> buffers(last - first);
+        for(auto i = first; i < last; ++i) {
+            pool.submit([&task = tasks[i], &code = buffers[i - first]] {
+                C_Generator generator{code};
+                for(auto j = task.begin; j < task.end; ++j) {
+                    generator.statement(*task.file->statements[j]);
+                }
+            });
+        }
+        pool.wait();
+        for(auto i = first; i < last; ++i) {
+            out.write(buffers[i - first].str());
+            if(tasks[i].last) {
+                out.write('\n');
+            }
+        }
+    }
+}
+
+std::vector<C_Shard> split_c_shards(const Ast& ast, std::size_t count) {
+    // Largest statements first, each to shard with least source so far.
+    struct Item {
+        std::size_t     size;
+        std::size_t     order;      // In source.
+        const Ast_Node* node;
+    };
+    std::vector<Item> items;
+    for(const auto& file : ast) {
+        for(std::size_t i = 0; i < file.statements.size(); ++i) {
+            const auto& stmt = *file.statements[i];
+            if(!is_type_declaration(stmt.node_type)) {
+                items.push_back({statement_size(file, i), items.size(), &stmt});
+            }
+        }
+    }
+    std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.size > b.size;
+    });
+    using Load = std::pair<std::size_t, std::size_t>;     // Size, shard.
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for(std::size_t i = 0; i < count; ++i) {
+        loads.push({0, i});
+    }
+    std::vector<std::vector<const Item*>> assigned(count);
+    for(const auto& item : items) {
+        auto load = loads.top();
+        loads.pop();
+        assigned[load.second].push_back(&item);
+        load.first += item.size;
+        loads.push(load);
+    }
+    std::vector<C_Shard> shards(count);
+    for(std::size_t i = 0; i < count; ++i) {
+        std::sort(assigned[i].begin(), assigned[i].end(), [](const Item* a, const Item* b) {
+            return a->order < b->order;
+        });
+        for(const auto item : assigned[i]) {
+            shards[i].push_back(item->node);
+        }
+    }
+    return shards;
+}
+
+std::vector<C_Shard> split_c_shards_per_file(const Ast& ast) {
+    std::vector<C_Shard> shards(ast.size());
+    for(std::size_t i = 0; i < ast.size(); ++i) {
+        for(const auto& stmt : ast[i].statements) {
+            if(!is_type_declaration(stmt->node_type)) {
+                shards[i].push_back(stmt);
+            }
+        }
+    }
+    return shards;
+}
+
+namespace {
+
+// Structs, enums and unions of all files. They go before everything else,
+// prototypes and globals may use any of them.
+void type_declarations(const Ast& ast, C_Generator& generator) {
+    for(const auto& file : ast) {
+        for(const auto& stmt : file.statements) {
+            if(is_type_declaration(stmt->node_type)) {
+                generator.statement(*stmt);
+            }
+        }
+    }
+}
+
+}
+
+void generate_c_declarations(const Ast& ast, C_Writer& out) {
+    C_Generator generator{out};
+    out.write("#pragma once\n").write(C_PRELUDE);
+    type_declarations(ast, generator);
+    for(const auto& file : ast) {
+        for(const auto& stmt : file.statements) {
+            if(stmt->node_type == Ast_Node_Type::FUNCTION_DECLARATION) {
+                generator.prototype(node_cast<Ast_Func_Decl>(*stmt));
+                out.write(";\n");
+            } else if(stmt->node_type == Ast_Node_Type::VARIABLE_DECLARATION) {
+                generator.extern_declaration(node_cast<Ast_Var_Decl>(*stmt));
+                out.write(";\n");
+            }
+        }
+    }
+}
+
+void generate_c_definitions(const C_Shard& shard, C_Writer& out) {
+    C_Generator generator{out};
+    for(const auto stmt : shard) {
+        generator.statement(*stmt);
+    }
+}
+
+void generate_c_unity(const Ast& ast, const std::vector<Atom>& exported, C_Writer& out) {
+    std::unordered_set<Atom> external{exported.begin(), exported.end()};
+    external.insert(intern("main"));
+    const auto linkage = [&](Atom name) {
+        if(external.count(name) == 0) {
+            out.write("static ");
+        }
+    };
+    C_Generator generator{out};
+    out.write(C_PRELUDE);
+    type_declarations(ast, generator);
+    // Prototypes of all functions, so they can be defined in any order.
+    for(const auto& file : ast) {
+        for(const auto& stmt : file.statements) {
+            if(stmt->node_type == Ast_Node_Type::FUNCTION_DECLARATION) {
+                const auto& func = node_cast<Ast_Func_Decl>(*stmt);
+                linkage(func.name);
+                generator.prototype(func);
+                out.write(";\n");
+            }
+        }
+    }
+    for(const auto& file : ast) {
+        for(const auto& stmt : file.statements) {
+            if(stmt->node_type == Ast_Node_Type::VARIABLE_DECLARATION) {
+                linkage(node_cast<Ast_Var_Decl>(*stmt).name);
+                generator.statement(*stmt);
+            }
+        }
+    }
+    for(const auto& file : ast) {
+        out.write('\n');
+        for(const auto& stmt : file.statements) {
+            if(stmt->node_type == Ast_Node_Type::FUNCTION_DECLARATION) {
+                linkage(node_cast<Ast_Func_Decl>(*stmt).name);
+            } else if(is_type_declaration(stmt->node_type)
+                    || stmt->node_type == Ast_Node_Type::VARIABLE_DECLARATION) {
+                continue;
+            }
+            generator.statement(*stmt);
+        }
+    }
+}
+
+std::string generate_c(const Ast_Node& node) {
+    C_Writer out;
+    generate_c(node, out);
+    return out.str();
+}
+
+std::string generate_c(const Flat_Ast& ast) {
+    C_Writer out;
+    generate_c(ast, out);
+    return out.str();
+}
+
+}
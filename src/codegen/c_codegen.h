@@ -0,0 +1,56 @@
+#ifndef TEZ_C_CODEGEN_H
+#define TEZ_C_CODEGEN_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "codegen/c_writer.h"
+#include "syntax/ast.h"
+#include "syntax/flat_ast.h"
+
+namespace tez {
+
+class Thread_Pool;
+
+// Includes and typedefs of builtin types, generated code starts with them.
+extern const std::string_view C_PRELUDE;
+
+// Write C code of node and everything below it in one pass. Nodes that have no C equivalent yet generate nothing.
+void generate_c(const Ast_Node& node, C_Writer& out);
+// Same code from flattened file.
+void generate_c(const Flat_Ast& ast, C_Writer& out);
+
+// Code of all files, each followed by empty line. Top-level statements are
+// generated by pool tasks into their own buffers and written out in source
+// order, so output is the same as from serial generation.
+void generate_c(const Ast& ast, C_Writer& out, Thread_Pool& pool);
+
+// Sharded output: one header with declarations of all files and several C
+// files with definitions that include it, so C compiler can build them in
+// parallel. Structs, enums and unions are only in header.
+using C_Shard = std::vector<const Ast_Node*>;     // Top-level statements.
+
+// Spread functions and global variables of all files over count shards, each
+// gets about the same amount of source. Shards keep source order.
+std::vector<C_Shard> split_c_shards(const Ast& ast, std::size_t count);
+// One shard for every file.
+std::vector<C_Shard> split_c_shards_per_file(const Ast& ast);
+
+// Prelude, types, function prototypes and extern declarations of globals.
+void generate_c_declarations(const Ast& ast, C_Writer& out);
+void generate_c_definitions(const C_Shard& shard, C_Writer& out);
+
+// Unity build: code of all files in one translation unit, ordered types,
+// prototypes, global variables and function bodies. Everything except main()
+// and exported names gets internal linkage, so C compiler sees whole program
+// and can inline across files or drop unused functions.
+void generate_c_unity(const Ast& ast, const std::vector<Atom>& exported, C_Writer& out);
+
+// Code of node in string, for tests and tools.
+std::string generate_c(const Ast_Node& node);
+std::string generate_c(const Flat_Ast& ast);
+
+}
+
+#endif //TEZ_C_CODEGEN_H
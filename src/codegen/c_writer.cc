@@ -0,0 +1,69 @@
+#include "c_writer.h"
+
+#include <cerrno>
+#include <charconv>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace tez {
+
+C_Writer::C_Writer(int fd)
+        : _fd{fd} {
+    _buffer.reserve(FLUSH_SIZE + FLUSH_SIZE / 4);
+}
+
+C_Writer::~C_Writer() {
+    try {
+        flush();
+    } catch(const std::system_error&) {
+    }
+}
+
+C_Writer& C_Writer::write_integer(std::int64_t value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return write(std::string_view{digits,
+            static_cast<std::size_t>(result.ptr - digits)});
+}
+
+C_Writer& C_Writer::write_real(double value) {
+    // Largest doubles have over 300 digits before decimal point.
+    char digits[512];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value,
+            std::chars_format::fixed, 6);
+    return write(std::string_view{digits,
+            static_cast<std::size_t>(result.ptr - digits)});
+}
+
+void C_Writer::indent() {
+    ++_indent_level;
+    if(_indent_level > _tabs.size()) {
+        _tabs.resize(_tabs.size() * 2, '\t');
+    }
+}
+
+void C_Writer::flush() {
+    if(_fd < 0) {
+        return;
+    }
+    std::size_t written = 0;
+    while(written < _buffer.size()) {
+        const auto n = ::write(_fd, _buffer.data() + written,
+                _buffer.size() - written);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n < 0) {
+            _buffer.erase(0, written);
+            _flushed += written;
+            throw std::system_error{errno, std::generic_category(),
+                    "Failed to write C code"};
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    _flushed += written;
+    _buffer.clear();
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef TEZ_C_WRITER_H
+#define TEZ_C_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "utils/atom_table.h"
+
+namespace tez {
+
+// Sink for generated C code. Code is appended to one buffer; writer opened
+// with file descriptor writes buffer out whenever it grows over FLUSH_SIZE,
+// otherwise whole code stays in memory, see str(). Write errors throw
+// std::system_error.
+class C_Writer {
+public:
+    static constexpr std::size_t FLUSH_SIZE = 256 * 1024;
+
+    C_Writer() = default;
+    // Descriptor isn't closed by writer.
+    explicit C_Writer(int fd);
+    C_Writer(const C_Writer&) = delete;
+    C_Writer& operator=(const C_Writer&) = delete;
+    // Flushes, but errors are lost; call flush() to see them.
+    ~C_Writer();
+
+    C_Writer& write(std::string_view text) {
+        _buffer.append(text);
+        return maybe_flush();
+    }
+    C_Writer& write(char c) {
+        _buffer.push_back(c);
+        return maybe_flush();
+    }
+    C_Writer& write(Atom atom) { return write(atom_name(atom)); }
+    C_Writer& write_integer(std::int64_t value);
+    // Formatted like std::to_string().
+    C_Writer& write_real(double value);
+
+    // Tabs for current indentation level; they are kept in one string, so
+    // nothing is allocated per line.
+    C_Writer& write_indent() {
+        return write(std::string_view{_tabs}.substr(0, _indent_level));
+    }
+    void indent();
+    void dedent() { --_indent_level; }
+
+    void flush();
+
+    // Bytes written since construction, including flushed ones.
+    std::size_t size() const { return _flushed + _buffer.size(); }
+    // Code not flushed yet; everything for writer without descriptor.
+    const std::string& str() const { return _buffer; }
+
+private:
+    C_Writer& maybe_flush() {
+        if(_fd >= 0 && _buffer.size() >= FLUSH_SIZE) {
+            flush();
+        }
+        return *this;
+    }
+
+    std::string _buffer;
+    int         _fd = -1;
+    std::size_t _flushed = 0;
+    std::size_t _indent_level = 0;
+    std::string _tabs = std::string(16, '\t');
+};
+
+}
+
+#endif //TEZ_C_WRITER_H
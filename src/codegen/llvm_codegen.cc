@@ -0,0 +1,108 @@
+#include "llvm_codegen.h"
+
+#include <vector>
+
+#include "syntax/ast_visitor.h"
+
+namespace tez {
+
+namespace {
+
+class LLVM_Generator final : public Ast_Visitor<LLVM_Generator, llvm::Value*> {
+public:
+    explicit LLVM_Generator(LLVM_Codegen_Data& codegen_data) : _data{codegen_data} {}
+
+    llvm::Value* visit_node(const Ast_Boolean& node);
+    llvm::Value* visit_node(const Ast_Integer& node);
+    llvm::Value* visit_node(const Ast_Real_Number& node);
+    llvm::Value* visit_node(const Ast_Binary_Operation& node);
+    llvm::Value* visit_node(const Ast_Func_Call& node);
+    // TODO: Everything else, including function declarations.
+    llvm::Value* visit_node([[maybe_unused]] const Ast_Node& node) { return nullptr; }
+
+private:
+    llvm::Value* binary(Operator operat, llvm::Value* l, llvm::Value* r);
+
+    LLVM_Codegen_Data& _data;
+};
+
+llvm::Value* LLVM_Generator::binary(Operator operat, llvm::Value* l, llvm::Value* r) {
+    if(l == nullptr || r == nullptr) {
+        // TODO: Return nullptr smells bad.
+        return nullptr;
+    }
+    switch(operat) {
+        case Operator::ADD:      return _data.builder.CreateFAdd(l, r, "tmpadd");
+        case Operator::SUBTRACT: return _data.builder.CreateFSub(l, r, "tmpsub");
+        case Operator::MULTIPLY: return _data.builder.CreateFMul(l, r, "tmpmul");
+        case Operator::DIVIDE:   return _data.builder.CreateFDiv(l, r, "tmpdiv");
+        default:                 return nullptr;    // TODO: Other operators.
+    }
+}
+
+llvm::Value* LLVM_Generator::visit_node(const Ast_Boolean& node) {
+    return llvm::ConstantInt::get(_data.context, llvm::APInt{8, static_cast<uint64_t>(node.value), false});
+}
+
+llvm::Value* LLVM_Generator::visit_node(const Ast_Integer& node) {
+    return llvm::ConstantInt::get(_data.context, llvm::APInt{64, static_cast<uint64_t>(node.value), true});
+}
+
+llvm::Value* LLVM_Generator::visit_node(const Ast_Real_Number& node) {
+    return llvm::ConstantFP::get(_data.context, llvm::APFloat{node.value});
+}
+
+llvm::Value* LLVM_Generator::visit_node(const Ast_Binary_Operation& node) {
+    // Post-order walk with explicit stack, expressions may be nested very
+    // deep. Operands are generated from left to right.
+    struct Frame {
+        const Ast_Node* node;
+        bool            expanded;   // Operands are already on value stack.
+    };
+    std::vector<Frame>        frames{{&node, false}};
+    std::vector<llvm::Value*> values;
+    while(!frames.empty()) {
+        const auto frame = frames.back();
+        frames.pop_back();
+        if(frame.node->node_type != Ast_Node_Type::BINARY_OPERATION) {
+            values.push_back(visit(*frame.node));
+            continue;
+        }
+        const auto& op = node_cast<Ast_Binary_Operation>(*frame.node);
+        if(!frame.expanded) {
+            frames.insert(frames.end(), {{frame.node, true}, {op.right, false}, {op.left, false}});
+            continue;
+        }
+        const auto r = values.back();
+        values.pop_back();
+        values.back() = binary(op.operat, values.back(), r);
+    }
+    return values.back();
+}
+
+llvm::Value* LLVM_Generator::visit_node(const Ast_Func_Call& node) {
+    const auto func_name = atom_name(node.name);
+    auto func = _data.module->getFunction({func_name.data(), func_name.size()});
+    if(func == nullptr) {
+        return nullptr;
+    }
+    if(func->arg_size() != node.args.size()) {
+        return nullptr;
+    }
+    std::vector<llvm::Value*> gen_args;
+    for(const auto& arg : node.args) {
+        gen_args.push_back(visit(*arg));
+        if(gen_args.back() == nullptr) {
+            return nullptr;
+        }
+    }
+    return _data.builder.CreateCall(func, gen_args, "calltmp");
+}
+
+}
+
+llvm::Value* generate_llvm(const Ast_Node& node, LLVM_Codegen_Data& codegen_data) {
+    return LLVM_Generator{codegen_data}.visit(node);
+}
+
+}
@@ -0,0 +1,25 @@
+#ifndef TEZ_LLVM_CODEGEN_H
+#define TEZ_LLVM_CODEGEN_H
+
+#include <memory>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+
+#include "syntax/ast.h"
+
+namespace tez {
+
+struct LLVM_Codegen_Data {
+    LLVM_Codegen_Data() : builder{context} {}
+    llvm::LLVMContext             context;
+    llvm::IRBuilder<>             builder{context};
+    std::unique_ptr<llvm::Module> module{std::make_unique<llvm::Module>("Main_Module", context)};
+};
+
+// Value of expression, nullptr if node isn't supported by LLVM backend yet.
+llvm::Value* generate_llvm(const Ast_Node& node, LLVM_Codegen_Data& codegen_data);
+
+}
+
+#endif //TEZ_LLVM_CODEGEN_H
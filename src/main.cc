@@ -1,5 +1,15 @@
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #if TEZ_DEBUG
 #   include <chrono>
@@ -8,28 +18,64 @@
 #include <llvm/Support/raw_ostream.h>
 
 //#include "semantic/semantic_analyzer.h"
+#include "codegen/c_codegen.h"
+#include "codegen/llvm_codegen.h"
+#include "syntax/diagnostics.h"
 #include "syntax/lexer.h"
 #include "syntax/parser.h"
+#include "utils/process.h"
+#include "utils/thread_pool.h"
 
 struct Compilation_Settings {
     std::vector<std::string> input_files;
     std::string              output_file = "output.c";
     bool                     use_llvm = false;
+    std::size_t              c_shards = 0;      // 0 means one C file.
+    bool                     c_shard_per_file = false;
+    bool                     c_unity = false;
+    std::vector<std::string> c_exports;
+    bool                     native = false;    // Build with C compiler.
+    bool                     compile_only = false;
+    std::string              optimization;      // e.g. "-O2", for C compiler.
+    std::size_t              jobs = 1;
+    std::size_t              error_limit = 20;
 };
 
 void print_help() {
     std::cout << "Usage: waywardc [options] [input_files]\n"
+            "Use '-' as input file to read from standard input.\n"
             "Options: \n"
             "  -h            - Display this information.\n"
-            "  -o <file>     - Place the output into <file>.\n"
+            "  -o <file>     - Place the output into <file>. Unless\n"
+            "                  <file> ends with '.c', it is built with C\n"
+            "                  compiler ($CC or cc); generated C files are\n"
+            "                  kept next to it.\n"
+            "  -c            - Build object file instead of executable.\n"
+            "  -O<level>     - Optimization level of C compiler: 0, 1, 2,\n"
+            "                  3, s, z, g or fast.\n"
+            "  -j <n>        - Lex, parse and generate code on up to <n>\n"
+            "                  threads; 0 uses all cores.\n"
+            "  -ferror-limit=<n>\n"
+            "                - Stop after <n> errors (20 by default); 0\n"
+            "                  means no limit.\n"
+            "  --c-shards=<n>\n"
+            "                - Split C output into header and <n> C files\n"
+            "                  that can be compiled in parallel; 'files'\n"
+            "                  makes one C file for every input file.\n"
+            "  --c-unity     - Generate one C file in which only main() and\n"
+            "                  exported names have external linkage.\n"
+            "  --c-export=<name>[,<name>...]\n"
+            "                - Keep external linkage of <name> in unity\n"
+            "                  build.\n"
             "  -llvm         - Use LLVM backend instead C backend.\n";
 }
 
 bool parse_command_line_arguments(const std::vector<std::string> args,
         Compilation_Settings& settings) {
     bool errors = false;
+    bool output_given = false;
     for(std::size_t i = 0; i < args.size(); ++i) {
-        if(args[i][0] != '-') {
+        if(args[i][0] != '-' || args[i] == "-") {    // "-" means stdin.
             settings.input_files.push_back(args[i]);
             continue;
         }
@@ -40,6 +86,7 @@ bool parse_command_line_arguments(const std::vector<std::string> args,
         try {
             if(args[i] == "-o") {
                 settings.output_file = args.at(++i);
+                output_given = true;
                 continue;
             }
         } catch(const std::out_of_range& e) {
@@ -47,6 +94,87 @@ bool parse_command_line_arguments(const std::vector<std::string> args,
             errors = true;
             continue;
         }
+        if(args[i].compare(0, 2, "-j") == 0) {
+            // Both "-j 8" and "-j8".
+            const auto value = args[i].size() > 2 ? args[i].substr(2)
+                    : i + 1 < args.size() ? args[++i] : "";
+            try {
+                std::size_t end = 0;
+                settings.jobs = std::stoul(value, &end);
+                if(end != value.size()) {
+                    throw std::invalid_argument{value};
+                }
+            } catch(const std::logic_error& e) {
+                std::cerr << "Error: Expected number of jobs after '-j'.\n";
+                errors = true;
+                continue;
+            }
+            if(settings.jobs == 0) {
+                settings.jobs = tez::Thread_Pool::hardware_threads();
+            }
+            continue;
+        }
+        constexpr std::string_view ERROR_LIMIT = "-ferror-limit=";
+        if(args[i].compare(0, ERROR_LIMIT.size(), ERROR_LIMIT) == 0) {
+            const auto value = args[i].substr(ERROR_LIMIT.size());
+            try {
+                std::size_t end = 0;
+                settings.error_limit = std::stoul(value, &end);
+                if(end != value.size()) {
+                    throw std::invalid_argument{value};
+                }
+            } catch(const std::logic_error& e) {
+                std::cerr << "Error: Expected number after '-ferror-limit='.\n";
+                errors = true;
+            }
+            continue;
+        }
+        constexpr std::string_view C_SHARDS = "--c-shards=";
+        if(args[i].compare(0, C_SHARDS.size(), C_SHARDS) == 0) {
+            const auto value = args[i].substr(C_SHARDS.size());
+            if(value == "files") {
+                settings.c_shard_per_file = true;
+                continue;
+            }
+            try {
+                std::size_t end = 0;
+                settings.c_shards = std::stoul(value, &end);
+                if(end != value.size() || settings.c_shards == 0) {
+                    throw std::invalid_argument{value};
+                }
+            } catch(const std::logic_error& e) {
+                std::cerr << "Error: Expected number or 'files' after "
+                        "'--c-shards='.\n";
+                errors = true;
+            }
+            continue;
+        }
+        if(args[i] == "-c") {
+            settings.compile_only = true;
+            continue;
+        }
+        if(args[i] == "-O0" || args[i] == "-O1" || args[i] == "-O2"
+                || args[i] == "-O3" || args[i] == "-Os" || args[i] == "-Oz"
+                || args[i] == "-Og" || args[i] == "-Ofast") {
+            settings.optimization = args[i];
+            continue;
+        }
+        if(args[i] == "--c-unity") {
+            settings.c_unity = true;
+            continue;
+        }
+        constexpr std::string_view C_EXPORT = "--c-export=";
+        if(args[i].compare(0, C_EXPORT.size(), C_EXPORT) == 0) {
+            for(auto begin = C_EXPORT.size(); begin <= args[i].size();) {
+                auto end = std::min(args[i].find(',', begin), args[i].size());
+                if(end > begin) {
+                    settings.c_exports.push_back(
+                            args[i].substr(begin, end - begin));
+                }
+                begin = end + 1;
+            }
+            continue;
+        }
         if(args[i] == "-llvm") {
             settings.use_llvm = true;
             continue;
@@ -54,27 +182,224 @@ bool parse_command_line_arguments(const std::vector<std::string> args,
         std::cerr << "Error: Unknown option '" + args[i] + "'.\n";
         errors = true;
     }
+    if(settings.c_unity
+            && (settings.c_shards > 0 || settings.c_shard_per_file)) {
+        std::cerr << "Error: '--c-unity' can't be used with '--c-shards='.\n";
+        errors = true;
+    }
+    const auto& output = settings.output_file;
+    const auto c_output = output.size() > 2
+            && output.compare(output.size() - 2, 2, ".c") == 0;
+    settings.native = settings.compile_only || !settings.optimization.empty()
+            || (output_given && !c_output);
+    if(settings.native && !output_given) {
+        settings.output_file = settings.compile_only ? "output.o" : "a.out";
+    } else if(settings.native && c_output) {
+        std::cerr << "Error: Output of '-c' or '-O' can't be C file.\n";
+        errors = true;
+    }
     return !errors;
 }
 
-int compile(const Compilation_Settings& settings) {
-    std::vector<tez::File_Tokens> tokenized_files;
+// Result of lexing and parsing one file.
+struct Parsed_File {
+    tez::Ast_File ast;
+    int           status = 0;
+};
+
+// Create file and write code from generate(C_Writer&) into it, straight from
+// generator to file, in chunks. Errors throw std::system_error.
+template<typename Generate>
+void write_c_file(const std::string& path, Generate generate) {
+    // Not inherited by C compilers started meanwhile.
+    const auto fd = ::open(path.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        throw std::system_error{errno, std::generic_category(),
+                "Failed to open file \"" + path + "\""};
+    }
+    try {
+        tez::C_Writer out{fd};
+        generate(out);
+        out.flush();
+    } catch(...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+// Code of all files in one C file.
+void write_c_source(const Compilation_Settings& settings, const tez::Ast& ast,
+        tez::Thread_Pool& pool, tez::C_Writer& out) {
+    if(settings.c_unity) {
+        std::vector<tez::Atom> exported;
+        for(const auto& name : settings.c_exports) {
+            exported.push_back(tez::intern(name));
+        }
+        tez::generate_c_unity(ast, exported, out);
+    } else {
+        out.write(tez::C_PRELUDE);
+        tez::generate_c(ast, out, pool);
+    }
+}
+
+std::vector<tez::C_Shard> split_c_shards(const Compilation_Settings& settings,
+        const tez::Ast& ast) {
+    return settings.c_shard_per_file ? tez::split_c_shards_per_file(ast)
+            : tez::split_c_shards(ast, settings.c_shards);
+}
+
+// Sharded output goes to header "<base>.h", shards "<base>.0.c",
+// "<base>.1.c", ... and manifest "<base>.manifest" that lists shards, one per
+// line. Header is written first, then shards are generated by pool tasks;
+// shard_written(i, path) is called by task that wrote shard i.
+void write_c_shards(const std::string& base, const tez::Ast& ast,
+        const std::vector<tez::C_Shard>& shards, tez::Thread_Pool& pool,
+        const std::function<void(std::size_t, const std::string&)>&
+                shard_written = {}) {
+    const auto header = base + ".h";
+    // Shards are next to header.
+    const auto slash = header.rfind('/');
+    const auto name = header.substr(slash == std::string::npos ? 0
+            : slash + 1);
+    const auto include = "#include \"" + name + "\"\n";
+    std::vector<std::string> paths;
+    for(std::size_t i = 0; i < shards.size(); ++i) {
+        paths.push_back(base + "." + std::to_string(i) + ".c");
+    }
+
+    write_c_file(header, [&ast](tez::C_Writer& out) {
+        tez::generate_c_declarations(ast, out);
+    });
+    for(std::size_t i = 0; i < shards.size(); ++i) {
+        pool.submit([&shards, &paths, &include, &shard_written, i] {
+            write_c_file(paths[i], [&shards, &include, i](tez::C_Writer& out) {
+                out.write(include);
+                tez::generate_c_definitions(shards[i], out);
+            });
+            if(shard_written) {
+                shard_written(i, paths[i]);
+            }
+        });
+    }
+    pool.wait();
+    write_c_file(base + ".manifest", [&paths](tez::C_Writer& out) {
+        for(const auto& path : paths) {
+            out.write(path).write('\n');
+        }
+    });
+}
+
+void run_c_compiler(const std::vector<std::string>& args) {
+    if(tez::Process{args}.wait() != 0) {
+        throw std::runtime_error{"C compiler failed"};
+    }
+}
+
+// Build output with C compiler. C files are named after output, e.g.
+// "a.out.c" or shards "a.out.0.c", ... Every shard is compiled as soon as
+// it's written, while the others are still generated; objects are then linked,
+// or combined into one object with -c.
+void build_native(const Compilation_Settings& settings, const tez::Ast& ast,
+        tez::Thread_Pool& pool) {
+    const auto cc = std::getenv("CC");
+    std::vector<std::string> command{cc != nullptr && *cc != '\0' ? cc : "cc"};
+    if(!settings.optimization.empty()) {
+        command.push_back(settings.optimization);
+    }
+    const auto& output = settings.output_file;
+    if(settings.c_shards == 0 && !settings.c_shard_per_file) {
+        const auto source = output + ".c";
+        write_c_file(source, [&](tez::C_Writer& out) {
+            write_c_source(settings, ast, pool, out);
+        });
+        if(settings.compile_only) {
+            command.push_back("-c");
+        }
+        command.insert(command.end(), {source, "-o", output});
+        run_c_compiler(command);
+        return;
+    }
+
+    const auto shards = split_c_shards(settings, ast);
+    std::vector<std::string>                  objects(shards.size());
+    std::vector<std::optional<tez::Process>>  compilers(shards.size());
+    write_c_shards(output, ast, shards, pool,
+            [&command, &objects, &compilers](std::size_t i,
+                    const std::string& path) {
+        objects[i] = path.substr(0, path.size() - 2) + ".o";
+        auto args = command;
+        args.insert(args.end(), {"-c", path, "-o", objects[i]});
+        compilers[i].emplace(args);
+    });
+    bool failed = false;
+    for(auto& compiler : compilers) {
+        failed |= compiler->wait() != 0;
+    }
+    if(failed) {
+        throw std::runtime_error{"C compiler failed"};
+    }
+    if(settings.compile_only) {
+        command.push_back("-r");
+    }
+    command.insert(command.end(), objects.begin(), objects.end());
+    command.insert(command.end(), {"-o", output});
+    run_c_compiler(command);
+}
+
+int compile(const Compilation_Settings& settings,
+        tez::Diagnostics& diagnostics) {
+    // Tokens and AST point into file table, it has to outlive both. All files
+    // are opened up front, workers only read the table.
+    tez::File_Table            files;
+    std::vector<tez::File_Id>  file_ids;
     for(const auto& f : settings.input_files) {
-        tez::Lexer lexer{f};
-        auto tokens = lexer.tokenize();
-        if(lexer.errors_reported()) {
+        try {
+            file_ids.push_back(files.open(f));
+        } catch(const tez::File_Not_Found& e) {
+            diagnostics.report(tez::Severity::ERROR, e.what());
+            diagnostics.flush(files, std::cerr);
             return 1;
         }
-        tokenized_files.push_back(tokens);
     }
-   
+
+    // Every file is lexed and parsed by one task; lexer and parser run
+    // interleaved, parser pulls tokens on demand. Diagnostics are collected
+    // from all workers and printed in input order when the phase ends.
+    std::vector<Parsed_File> parsed(file_ids.size());
+    {
+        tez::Thread_Pool pool{std::min(settings.jobs, file_ids.size())};
+        for(std::size_t i = 0; i < file_ids.size(); ++i) {
+            pool.submit([&files, &file_ids, &parsed, &diagnostics, i] {
+                auto& result = parsed[i];
+                if(diagnostics.limit_reached()) {
+                    result.status = 2;
+                    return;
+                }
+                tez::Lexer  lexer{files, file_ids[i], diagnostics};
+                tez::Parser parser{lexer, files, diagnostics};
+                result.ast = parser.parse();
+                if(lexer.errors_reported()) {
+                    result.status = 1;
+                } else if(parser.errors_reported()) {
+                    result.status = 2;
+                }
+            });
+        }
+        pool.wait();
+    }
+    diagnostics.flush(files, std::cerr);
     tez::Ast ast;
-    for(const auto& file : tokenized_files) {
-        tez::Parser parser{file};
-        ast.push_back(parser.parse());
-        if(parser.errors_reported()) {
-            return 2;
+    int      status = 0;
+    for(auto& result : parsed) {
+        if(status == 0) {
+            status = result.status;
         }
+        ast.push_back(std::move(result.ast));
+    }
+    if(status != 0) {
+        return status;
     }
 
     //tez::Semantic_Analyzer analyzer{};
@@ -89,33 +414,25 @@ int compile(const Compilation_Settings& settings) {
         }
         codegen_data.module->print(llvm::errs(), nullptr);
     } else {
-        tez::C_Codegen_Data codegen_data;
-        std::stringstream c_source;
-        c_source <<
-                "#include<stdio.h>\n"
-                "#include<stdlib.h>\n"
-                "#include<stdint.h>\n"
-                "typedef void     Void;\n"
-                "typedef char     Bool;\n"
-                "typedef char     Char;\n"
-                "typedef int      Int;\n"
-                "typedef unsigned int Uint;\n"
-                "typedef int8_t   Int8;\n"
-                "typedef int16_t  Int16;\n"
-                "typedef int32_t  Int32;\n"
-                "typedef int64_t  Int64;\n"
-                "typedef uint8_t  Uint8;\n"
-                "typedef uint16_t Uint16;\n"
-                "typedef uint32_t Uint32;\n"
-                "typedef uint64_t Uint64;\n"
-                "typedef float    Float;\n"
-                "typedef double   Double;\n";
-        for(const auto& f : ast) {
-            c_source << f.generate_c(codegen_data) << '\n';
-        }
-        std::ofstream of{settings.output_file};
-        auto tmp = c_source.str();
-        of << tmp;
+        try {
+            tez::Thread_Pool pool{settings.jobs};
+            if(settings.native) {
+                build_native(settings, ast, pool);
+            } else if(settings.c_shards > 0 || settings.c_shard_per_file) {
+                // "out.c" -> "out.h", "out.0.c", ...
+                const auto& output = settings.output_file;
+                write_c_shards(output.substr(0, output.size() - 2), ast,
+                        split_c_shards(settings, ast), pool);
+            } else {
+                write_c_file(settings.output_file, [&](tez::C_Writer& out) {
+                    write_c_source(settings, ast, pool, out);
+                });
+            }
+        } catch(const std::runtime_error& e) {
+            diagnostics.report(tez::Severity::ERROR, e.what());
+            diagnostics.flush(files, std::cerr);
+            return 1;
+        }
     }
     return 0;
 }
@@ -136,10 +453,10 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    auto return_code = compile(settings);
+    tez::Diagnostics diagnostics{settings.error_limit};
+    auto return_code = compile(settings, diagnostics);
     if(return_code) {
-        // TODO: Count errors :)
-        std::cout << "<> errors reported.\n";
+        std::cout << diagnostics.error_count() << " errors reported.\n";
     } else {
         std::cout << "No errors reported.\n";
     }
@@ -7,22 +7,22 @@ namespace tez {
 Symbol_Table::Symbol_Table() {
     // Create global scope.
     _scopes.emplace_back();
-    _scopes.back().push_back(make_built_in("Void"));
-    _scopes.back().push_back(make_built_in("Bool"));
-    _scopes.back().push_back(make_built_in("Char"));
-    _scopes.back().push_back(make_built_in("Rune"));
-    _scopes.back().push_back(make_built_in("Int"));
-    _scopes.back().push_back(make_built_in("Uint"));
-    _scopes.back().push_back(make_built_in("Int8"));
-    _scopes.back().push_back(make_built_in("Int16"));
-    _scopes.back().push_back(make_built_in("Int32"));
-    _scopes.back().push_back(make_built_in("Int64"));
-    _scopes.back().push_back(make_built_in("Uint8"));
-    _scopes.back().push_back(make_built_in("Uint16"));
-    _scopes.back().push_back(make_built_in("Uint32"));
-    _scopes.back().push_back(make_built_in("Uint64"));
-    _scopes.back().push_back(make_built_in("Float"));
-    _scopes.back().push_back(make_built_in("Double"));
+    push_symbol(make_built_in("Void"));
+    push_symbol(make_built_in("Bool"));
+    push_symbol(make_built_in("Char"));
+    push_symbol(make_built_in("Rune"));
+    push_symbol(make_built_in("Int"));
+    push_symbol(make_built_in("Uint"));
+    push_symbol(make_built_in("Int8"));
+    push_symbol(make_built_in("Int16"));
+    push_symbol(make_built_in("Int32"));
+    push_symbol(make_built_in("Int64"));
+    push_symbol(make_built_in("Uint8"));
+    push_symbol(make_built_in("Uint16"));
+    push_symbol(make_built_in("Uint32"));
+    push_symbol(make_built_in("Uint64"));
+    push_symbol(make_built_in("Float"));
+    push_symbol(make_built_in("Double"));
 }
 
 void Symbol_Table::push_scope() {
@@ -34,12 +34,22 @@ void Symbol_Table::pop_scope() {
 }
 
 void Symbol_Table::push_symbol(Symbol&& symbol) {
-    _scopes.back().push_back(std::move(symbol));
+    const auto name = symbol.name;
+    _scopes.back().insert_or_assign(name, std::move(symbol));
 }
 
-Symbol make_built_in(std::string&& name) {
-    return Symbol{Symbol_Type::BUILT_IN, Built_In{std::move(name)}};
+const Symbol* Symbol_Table::find(Atom name) const {
+    for(auto scope = _scopes.rbegin(); scope != _scopes.rend(); ++scope) {
+        if(auto it = scope->find(name); it != scope->end()) {
+            return &it->second;
+        }
+    }
+    return nullptr;
 }
 
+Symbol make_built_in(std::string_view name) {
+    const auto atom = intern(name);
+    return Symbol{Symbol_Type::BUILT_IN, atom, Built_In{atom}};
 }
 
+}
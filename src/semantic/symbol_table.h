@@ -1,22 +1,25 @@
 #ifndef TEZ_SYMBOL_TABLE_H
 #define TEZ_SYMBOL_TABLE_H
 
-#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
+#include "utils/atom_table.h"
+
 namespace tez {
 
 struct Built_In {
-    std::string name;
+    Atom name;
 };
 
 struct Function {
     struct Param {
-        std::string name;
+        Atom name;
         //Type        type;
     };
-    std::string        name;
+    Atom               name;
     std::vector<Param> params;
     //Type        return_type;
 };
@@ -29,11 +32,13 @@ using Symbol_Data = std::variant<Built_In>;
 
 struct Symbol {
     Symbol_Type type;
+    Atom        name;
     Symbol_Data data;
 };
 
 // It doesn't support namespaces yet.
 class Symbol_Table {
+public:
     Symbol_Table();
 
     void push_scope();
@@ -42,15 +47,19 @@ class Symbol_Table {
     // Add new symbol to current scope.
     void push_symbol(Symbol&& symbol);
 
-public:
+    // Find symbol visible from current scope; nullptr if there is none.
+    const Symbol* find(Atom name) const;
+
 private:
-    std::vector<std::vector<Symbol>> _scopes;
+    // Names are atoms, so lookup in scope is hashing an integer.
+    using Scope = std::unordered_map<Atom, Symbol>;
+
+    std::vector<Scope> _scopes;
 };
 
-Symbol make_built_in(std::string&& name);
-Symbol make_function(std::string&& name);
+Symbol make_built_in(std::string_view name);
+Symbol make_function(std::string_view name);
 
 }
 
 #endif // TEZ_SYMBOL_TABLE_H
-
@@ -1,28 +1,17 @@
 #ifndef TEZ_AST_H
 #define TEZ_AST_H
 
-#include <sstream>
 #include <memory>
+#include <string_view>
 #include <vector>
 
-#include <llvm/IR/IRBuilder.h>
-#include <llvm/IR/Module.h>
+#include "syntax/ast_arena.h"
+#include "syntax/file_table.h"
+#include "utils/atom_table.h"
 
 namespace tez {
 
-struct C_Codegen_Data {
-    std::string print_indent() const { return std::string(indent_level, '\t'); }
-    std::size_t indent_level = 0;
-};
-
-struct LLVM_Codegen_Data {
-    LLVM_Codegen_Data() : builder{context} {}
-    llvm::LLVMContext             context;
-    llvm::IRBuilder<>             builder{context};
-    std::unique_ptr<llvm::Module> module{std::make_unique<llvm::Module>("Main_Module", context)};
-};
-
-enum class Ast_Node_Type {
+enum class Ast_Node_Type : std::uint8_t {
     UNDEFINED,
 
     FILE,
@@ -80,290 +69,328 @@ enum class Ast_Node_Type {
     INLINE_ASM,
 };
 
-// Base class for all AST nodes.
+enum class Operator : std::uint8_t {
+    // Binary.
+    ASSIGN,
+    ADD_ASSIGN,
+    SUBTRACT_ASSIGN,
+    MULTIPLY_ASSIGN,
+    DIVIDE_ASSIGN,
+    MODULO_ASSIGN,
+    AND_ASSIGN,
+    OR_ASSIGN,
+    XOR_ASSIGN,
+    SHIFT_LEFT_ASSIGN,
+    SHIFT_RIGHT_ASSIGN,
+    LOGICAL_OR,
+    LOGICAL_AND,
+    BITWISE_OR,
+    BITWISE_XOR,
+    BITWISE_AND,
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    SHIFT_LEFT,
+    SHIFT_RIGHT,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    MODULO,
+
+    // Unary.
+    NOT,
+    NEGATE,
+};
+
+// Operator as written in both Tez and C.
+std::string_view spelling(Operator op);
+
+// Base class for all AST nodes. Nodes are allocated in Ast_Arena of their
+// file and are never destroyed, so their members must not own any memory.
+// Nodes have no virtual methods; passes switch on node_type, see Ast_Visitor.
+// Every node type declares TYPE, which node_cast() checks in debug builds.
 struct Ast_Node {
-    virtual ~Ast_Node() = default;
     Ast_Node_Type node_type = Ast_Node_Type::UNDEFINED;
-    // This 2 methods should be pure virtual, but because they are implemented yet in all of the nodes, it's the only
-    // way to force compiler to compile it.
-    virtual std::string generate_c([[maybe_unused]] C_Codegen_Data& codegen_data) const { return ""; };
-    virtual llvm::Value* generate_llvm([[maybe_unused]] LLVM_Codegen_Data& codegen_data) const { return nullptr; };
 };
-using Ast_Node_Ptr = std::unique_ptr<Ast_Node>;
+using Ast_Node_Ptr = Ast_Node*;     // Owned by Ast_Arena.
 
 struct Ast_File final : Ast_Node {
-    Ast_File() { node_type = Ast_Node_Type::FILE; }
-    std::string generate_c(C_Codegen_Data& data) const override;
-    std::vector<Ast_Node_Ptr> statements;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::FILE;
+    Ast_File() { node_type = TYPE; }
+    std::vector<Ast_Node_Ptr>  statements;
+    // Bytes of every statement, including whitespace and comments after it;
+    // ranges cover the file without gaps. Used by Parser::reparse().
+    std::vector<Source_Range>  ranges;
+    std::unique_ptr<Ast_Arena> arena;       // Owns all nodes of the file.
 };
 using Ast = std::vector<Ast_File>;
 
 struct Ast_Block final : Ast_Node {
-    Ast_Block() { node_type = Ast_Node_Type::BLOCK; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const;
-    std::vector<Ast_Node_Ptr> statements;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::BLOCK;
+    Ast_Block() { node_type = TYPE; }
+    Ast_List<Ast_Node_Ptr> statements;
 };
 
 struct Ast_Namespace final : Ast_Node {
-    Ast_Namespace() { node_type = Ast_Node_Type::NAMESPACE; }
-    std::string name;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::NAMESPACE;
+    Ast_Namespace() { node_type = TYPE; }
+    Atom        name;
     Ast_Block   body;
 };
 
 struct Ast_Using final : Ast_Node {
-    Ast_Using() { node_type = Ast_Node_Type::USING; }
-    std::string nspace;
-    std::string alias;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::USING;
+    Ast_Using() { node_type = TYPE; }
+    Atom nspace;
+    Atom alias;
 };
 
 struct Ast_Boolean final : Ast_Node {
-    Ast_Boolean() { node_type = Ast_Node_Type::BOOLEAN; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    llvm::Value* generate_llvm(LLVM_Codegen_Data& codegen_data) const override;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::BOOLEAN;
+    Ast_Boolean() { node_type = TYPE; }
     bool value;
 };
 
 struct Ast_Integer final : Ast_Node {
-    Ast_Integer() { node_type = Ast_Node_Type::INTEGER; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    llvm::Value* generate_llvm(LLVM_Codegen_Data& codegen_data) const override;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::INTEGER;
+    Ast_Integer() { node_type = TYPE; }
     int64_t value;
 };
 
 struct Ast_Real_Number final : Ast_Node {
-    Ast_Real_Number() { node_type = Ast_Node_Type::REAL_NUMBER; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    llvm::Value* generate_llvm(LLVM_Codegen_Data& codegen_data) const override;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::REAL_NUMBER;
+    Ast_Real_Number() { node_type = TYPE; }
     double value;
 };
 
 struct Ast_String final : Ast_Node {
-    Ast_String() { node_type = Ast_Node_Type::STRING; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::string value;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::STRING;
+    Ast_String() { node_type = TYPE; }
+    std::string_view value;
 };
 
 struct Ast_Identifier final : Ast_Node {
-    Ast_Identifier() { node_type = Ast_Node_Type::IDENTIFIER; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::string name;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::IDENTIFIER;
+    Ast_Identifier() { node_type = TYPE; }
+    Atom name;
 };
 
 struct Ast_Unary_Operation final : Ast_Node {
-    Ast_Unary_Operation() { node_type = Ast_Node_Type::UNARY_OPERATION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr left;
-    std::string  operat;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::UNARY_OPERATION;
+    Ast_Unary_Operation() { node_type = TYPE; }
+    Ast_Node_Ptr left = nullptr;
+    Operator     operat;
 };
 
 struct Ast_Binary_Operation final : Ast_Node {
-    Ast_Binary_Operation() { node_type = Ast_Node_Type::BINARY_OPERATION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    llvm::Value* generate_llvm(LLVM_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr left;
-    Ast_Node_Ptr right;
-    std::string  operat;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::BINARY_OPERATION;
+    Ast_Binary_Operation() { node_type = TYPE; }
+    Ast_Node_Ptr left = nullptr;
+    Ast_Node_Ptr right = nullptr;
+    Operator     operat;
 };
 
 struct Ast_Grouping_Expression final : Ast_Node {
-    Ast_Grouping_Expression() { node_type = Ast_Node_Type::GROUPING_EXPRESSION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr expr;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::GROUPING_EXPRESSION;
+    Ast_Grouping_Expression() { node_type = TYPE; }
+    Ast_Node_Ptr expr = nullptr;
 };
 
 struct Ast_Cast final : Ast_Node {
-    Ast_Cast() { node_type = Ast_Node_Type::CAST; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr expr;      // Expression to cast.
-    Ast_Node_Ptr to;        // Type to cast to.
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::CAST;
+    Ast_Cast() { node_type = TYPE; }
+    Ast_Node_Ptr expr = nullptr;    // Expression to cast.
+    Ast_Node_Ptr to = nullptr;      // Type to cast to.
 };
 
 struct Ast_Address_Of final : Ast_Node {
-    Ast_Address_Of() { node_type = Ast_Node_Type::ADDRESS_OF; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr expr;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::ADDRESS_OF;
+    Ast_Address_Of() { node_type = TYPE; }
+    Ast_Node_Ptr expr = nullptr;
 };
 
 struct Ast_Func_Decl : Ast_Node {
     struct Param {
-        std::string  name;
-        bool         constant;
-        Ast_Node_Ptr type;
+        Atom         name;
+        bool         constant = true;
+        Ast_Node_Ptr type = nullptr;
     };
-    Ast_Func_Decl() { node_type = Ast_Node_Type::FUNCTION_DECLARATION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    llvm::Value* generate_llvm(LLVM_Codegen_Data& codegen_data) const override;
-    std::string        parent;  // Free function if parent == "".
-    std::string        name;
-    std::vector<Param> params;
-    Ast_Node_Ptr       return_type;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::FUNCTION_DECLARATION;
+    Ast_Func_Decl() { node_type = TYPE; }
+    Atom               parent{};    // Free function if parent is empty.
+    Atom               name;
+    Ast_List<Param>    params;
+    Ast_Node_Ptr       return_type = nullptr;
     Ast_Block          body;
 };
 
 struct Ast_Return final : Ast_Node {
-    Ast_Return() { node_type = Ast_Node_Type::RETURN; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr expr;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::RETURN;
+    Ast_Return() { node_type = TYPE; }
+    Ast_Node_Ptr expr = nullptr;
 };
 
 struct Ast_Func_Call final : Ast_Node {
-    Ast_Func_Call() { node_type = Ast_Node_Type::FUNCTION_CALL; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    llvm::Value* generate_llvm(LLVM_Codegen_Data& codegen_data) const override;
-    std::string               name;
-    std::vector<Ast_Node_Ptr> args;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::FUNCTION_CALL;
+    Ast_Func_Call() { node_type = TYPE; }
+    Atom                      name;
+    Ast_List<Ast_Node_Ptr> args;
 };
 
 struct Ast_Var_Decl final : Ast_Node {
-    Ast_Var_Decl() { node_type = Ast_Node_Type::VARIABLE_DECLARATION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::string  name;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::VARIABLE_DECLARATION;
+    Ast_Var_Decl() { node_type = TYPE; }
+    Atom         name;
     bool         constant;
-    Ast_Node_Ptr type;
-    Ast_Node_Ptr initializer;
+    Ast_Node_Ptr type = nullptr;
+    Ast_Node_Ptr initializer = nullptr;
 };
 
 struct Ast_If final : Ast_Node {
-    Ast_If() { node_type = Ast_Node_Type::IF; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr condition;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::IF;
+    Ast_If() { node_type = TYPE; }
+    Ast_Node_Ptr condition = nullptr;
     Ast_Block    if_block;
-    Ast_Node_Ptr else_block;
+    Ast_Node_Ptr else_block = nullptr;
 };
 
 struct Ast_While final : Ast_Node {
-    Ast_While() { node_type = Ast_Node_Type::WHILE; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr condition;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::WHILE;
+    Ast_While() { node_type = TYPE; }
+    Ast_Node_Ptr condition = nullptr;
     Ast_Block    body;
 };
 
 struct Ast_Do_While final : Ast_Node {
-    Ast_Do_While() { node_type = Ast_Node_Type::DO_WHILE; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr condition;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::DO_WHILE;
+    Ast_Do_While() { node_type = TYPE; }
+    Ast_Node_Ptr condition = nullptr;
     Ast_Block    body;
 };
 
 struct Ast_For final : Ast_Node {
-    Ast_For() { node_type = Ast_Node_Type::FOR; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr init_statement;
-    Ast_Node_Ptr condition;
-    Ast_Node_Ptr iteration_expr;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::FOR;
+    Ast_For() { node_type = TYPE; }
+    Ast_Node_Ptr init_statement = nullptr;
+    Ast_Node_Ptr condition = nullptr;
+    Ast_Node_Ptr iteration_expr = nullptr;
     Ast_Block    body;
 };
 
 struct Ast_Break final : Ast_Node {
-    Ast_Break() { node_type = Ast_Node_Type::BREAK; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::BREAK;
+    Ast_Break() { node_type = TYPE; }
 };
 
 struct Ast_Continue final : Ast_Node {
-    Ast_Continue() { node_type = Ast_Node_Type::CONTINUE; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::CONTINUE;
+    Ast_Continue() { node_type = TYPE; }
 };
 
 struct Ast_Struct final : Ast_Node {
     struct Field {
-        std::string  name;
-        Ast_Node_Ptr type;
+        Atom         name;
+        Ast_Node_Ptr type = nullptr;
     };
-    Ast_Struct() { node_type = Ast_Node_Type::STRUCT; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::string        name;
-    std::vector<Field> fields;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::STRUCT;
+    Ast_Struct() { node_type = TYPE; }
+    Atom               name;
+    Ast_List<Field>    fields;
 };
 
 struct Ast_Enum final : Ast_Node {
     struct Enumerator {
-        std::string name;
-        int         value;
+        Atom name;
+        int  value;
     };
-    Ast_Enum() { node_type = Ast_Node_Type::ENUM; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::string             name;
-    std::vector<Enumerator> enumerations;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::ENUM;
+    Ast_Enum() { node_type = TYPE; }
+    Atom                    name;
+    Ast_List<Enumerator>    enumerations;
 };
 
 struct Ast_Union_Decl final : Ast_Node {
     struct Member {
-        std::string  name;
-        Ast_Node_Ptr type;
+        Atom         name;
+        Ast_Node_Ptr type = nullptr;
     };
-    Ast_Union_Decl() { node_type = Ast_Node_Type::UNION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::string         name;
-    std::vector<Member> members;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::UNION;
+    Ast_Union_Decl() { node_type = TYPE; }
+    Atom                name;
+    Ast_List<Member>    members;
 };
 
 struct Ast_Array_Access final : Ast_Node {
-    Ast_Array_Access() { node_type = Ast_Node_Type::ARRAY_ACCESS; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr array;
-    Ast_Node_Ptr at;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::ARRAY_ACCESS;
+    Ast_Array_Access() { node_type = TYPE; }
+    Ast_Node_Ptr array = nullptr;
+    Ast_Node_Ptr at = nullptr;
 };
 
 struct Ast_Member_Access final : Ast_Node {
-    Ast_Member_Access() { node_type = Ast_Node_Type::MEMBER_ACCESS; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr left;
-    Ast_Node_Ptr right;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::MEMBER_ACCESS;
+    Ast_Member_Access() { node_type = TYPE; }
+    Ast_Node_Ptr left = nullptr;
+    Ast_Node_Ptr right = nullptr;
 };
 
 struct Ast_Scope_Resolution final : Ast_Node {
-    Ast_Scope_Resolution() { node_type = Ast_Node_Type::SCOPE_RESOLUTION; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr left;
-    Ast_Node_Ptr right;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::SCOPE_RESOLUTION;
+    Ast_Scope_Resolution() { node_type = TYPE; }
+    Ast_Node_Ptr left = nullptr;
+    Ast_Node_Ptr right = nullptr;
 };
 
 struct Ast_Ptr_Dereference final : Ast_Node {
-    Ast_Ptr_Dereference() { node_type = Ast_Node_Type::PTR_DEREFERENCE; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr expr;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::PTR_DEREFERENCE;
+    Ast_Ptr_Dereference() { node_type = TYPE; }
+    Ast_Node_Ptr expr = nullptr;
 };
 
 struct Ast_New final : Ast_Node {
-    Ast_New() { node_type = Ast_Node_Type::NEW; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr type;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::NEW;
+    Ast_New() { node_type = TYPE; }
+    Ast_Node_Ptr type = nullptr;
 };
 
 struct Ast_Free final : Ast_Node {
-    Ast_Free() { node_type = Ast_Node_Type::FREE; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr what;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::FREE;
+    Ast_Free() { node_type = TYPE; }
+    Ast_Node_Ptr what = nullptr;
 };
 
 struct Ast_Null final : Ast_Node {
-    Ast_Null() { node_type = Ast_Node_Type::NULL_; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::NULL_;
+    Ast_Null() { node_type = TYPE; }
 };
 
 struct Ast_Array_Initializer final : Ast_Node {
-    Ast_Array_Initializer() { node_type = Ast_Node_Type::ARRAY_INITIALIZER; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::vector<Ast_Node_Ptr> values;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::ARRAY_INITIALIZER;
+    Ast_Array_Initializer() { node_type = TYPE; }
+    Ast_List<Ast_Node_Ptr> values;
 };
 
 struct Ast_Pointer final : Ast_Node {
-    Ast_Pointer() { node_type = Ast_Node_Type::POINTER; };
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr expr;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::POINTER;
+    Ast_Pointer() { node_type = TYPE; }
+    Ast_Node_Ptr expr = nullptr;
 };
 
 struct Ast_Array final : Ast_Node {
-    Ast_Array() { node_type = Ast_Node_Type::ARRAY; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    Ast_Node_Ptr type;
-    Ast_Node_Ptr size;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::ARRAY;
+    Ast_Array() { node_type = TYPE; }
+    Ast_Node_Ptr type = nullptr;
+    Ast_Node_Ptr size = nullptr;
 };
 
 struct Ast_Inline_Asm final : Ast_Node {
-    Ast_Inline_Asm() { node_type = Ast_Node_Type::INLINE_ASM; }
-    std::string generate_c(C_Codegen_Data& codegen_data) const override;
-    std::vector<std::string> operations;
+    static constexpr Ast_Node_Type TYPE = Ast_Node_Type::INLINE_ASM;
+    Ast_Inline_Asm() { node_type = TYPE; }
+    Ast_List<std::string_view> operations;
 };
 
 }
@@ -0,0 +1,41 @@
+#include "ast_arena.h"
+
+#include <cstring>
+
+namespace tez {
+
+void* Ast_Arena::allocate(std::size_t size, std::size_t alignment) {
+    auto aligned = [alignment](char* p) {
+        const auto address = reinterpret_cast<std::uintptr_t>(p);
+        return p + (-address & (alignment - 1));
+    };
+    // Big allocations get block of their own, so rest of current block isn't
+    // wasted.
+    if(size > BLOCK_SIZE / 4) {
+        const auto block_size = size + alignment;
+        _blocks.emplace_back(new char[block_size]);
+        _capacity += block_size;
+        return aligned(_blocks.back().get());
+    }
+    char* result = aligned(_current);
+    if(_current == nullptr || size > static_cast<std::size_t>(_end - result)) {
+        _blocks.emplace_back(new char[BLOCK_SIZE]);
+        _current = _blocks.back().get();
+        _end = _current + BLOCK_SIZE;
+        _capacity += BLOCK_SIZE;
+        result = aligned(_current);
+    }
+    _current = result + size;
+    return result;
+}
+
+std::string_view Ast_Arena::copy(std::string_view text) {
+    if(text.empty()) {
+        return {};
+    }
+    auto data = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(data, text.data(), text.size());
+    return {data, text.size()};
+}
+
+}
@@ -0,0 +1,93 @@
+#ifndef TEZ_AST_ARENA_H
+#define TEZ_AST_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tez {
+
+// Bump allocator owning AST of one file. Nodes are never freed one by one,
+// arena releases its blocks at once when it's destroyed, without running
+// destructors. Therefore nothing allocated here may own memory outside of
+// arena - use Ast_List instead of std::vector, and copy() for strings.
+class Ast_Arena {
+public:
+    Ast_Arena() = default;
+    Ast_Arena(const Ast_Arena&) = delete;
+    Ast_Arena& operator=(const Ast_Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    template<typename T, typename... Args>
+    T* make(Args&&... args) {
+        return new(allocate(sizeof(T), alignof(T)))
+                T(std::forward<Args>(args)...);
+    }
+
+    // Copy text into arena; returned view lives as long as arena.
+    std::string_view copy(std::string_view text);
+
+    // Sum of sizes of all blocks.
+    std::size_t capacity() const { return _capacity; }
+
+private:
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    char*                                _current = nullptr;
+    char*                                _end = nullptr;
+    std::size_t                          _capacity = 0;
+};
+
+// Growable array allocated in Ast_Arena. It doubles like std::vector, old
+// storage is left in the arena, so lists waste at most as much as they use.
+template<typename T>
+class Ast_List {
+public:
+    static_assert(std::is_trivially_destructible_v<T>,
+            "Arena doesn't run destructors.");
+
+    void push_back(Ast_Arena& arena, const T& value) {
+        if(_size == _capacity) {
+            grow(arena);
+        }
+        new(_data + _size) T(value);
+        ++_size;
+    }
+
+    T* begin() { return _data; }
+    T* end() { return _data + _size; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+
+    T& operator[](std::size_t index) { return _data[index]; }
+    const T& operator[](std::size_t index) const { return _data[index]; }
+    T& back() { return _data[_size - 1]; }
+    const T& back() const { return _data[_size - 1]; }
+
+    std::size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+private:
+    void grow(Ast_Arena& arena) {
+        const std::uint32_t capacity = _capacity == 0 ? 4 : _capacity * 2;
+        auto data = static_cast<T*>(
+                arena.allocate(capacity * sizeof(T), alignof(T)));
+        std::uninitialized_copy(begin(), end(), data);
+        _data = data;
+        _capacity = capacity;
+    }
+
+    T*            _data = nullptr;
+    std::uint32_t _size = 0;
+    std::uint32_t _capacity = 0;
+};
+
+}
+
+#endif //TEZ_AST_ARENA_H
@@ -0,0 +1,128 @@
+#ifndef TEZ_AST_VISITOR_H
+#define TEZ_AST_VISITOR_H
+
+#include <cassert>
+
+#include "syntax/ast.h"
+
+namespace tez {
+
+// Downcast node to its concrete type. Type is checked only in debug builds,
+// in release it's plain static_cast.
+template<typename T>
+const T& node_cast(const Ast_Node& node) {
+    assert(node.node_type == T::TYPE && "Wrong node type.");
+    return static_cast<const T&>(node);
+}
+
+template<typename T>
+T& node_cast(Ast_Node& node) {
+    assert(node.node_type == T::TYPE && "Wrong node type.");
+    return static_cast<T&>(node);
+}
+
+// Static dispatch on node type, replacement for virtual methods on nodes.
+// Derived class implements visit_node() overload for every node type it
+// handles and overload taking const Ast_Node& for all the others, e.g.
+//
+//     struct Counter : Ast_Visitor<Counter, int> {
+//         int visit_node(const Ast_Integer& node) { return 1; }
+//         int visit_node(const Ast_Node& node) { return 0; }
+//     };
+//
+// visit() switches on node_type and calls best overload directly, so calls can
+// be inlined. Visitors walk children themselves, by calling visit() again or
+// with explicit stack.
+template<typename Derived, typename Result>
+class Ast_Visitor {
+public:
+    Result visit(const Ast_Node& node) {
+        auto& self = static_cast<Derived&>(*this);
+        switch(node.node_type) {
+        case Ast_Node_Type::FILE:
+            return self.visit_node(node_cast<Ast_File>(node));
+        case Ast_Node_Type::BLOCK:
+            return self.visit_node(node_cast<Ast_Block>(node));
+        case Ast_Node_Type::NAMESPACE:
+            return self.visit_node(node_cast<Ast_Namespace>(node));
+        case Ast_Node_Type::USING:
+            return self.visit_node(node_cast<Ast_Using>(node));
+        case Ast_Node_Type::BOOLEAN:
+            return self.visit_node(node_cast<Ast_Boolean>(node));
+        case Ast_Node_Type::INTEGER:
+            return self.visit_node(node_cast<Ast_Integer>(node));
+        case Ast_Node_Type::REAL_NUMBER:
+            return self.visit_node(node_cast<Ast_Real_Number>(node));
+        case Ast_Node_Type::STRING:
+            return self.visit_node(node_cast<Ast_String>(node));
+        case Ast_Node_Type::IDENTIFIER:
+            return self.visit_node(node_cast<Ast_Identifier>(node));
+        case Ast_Node_Type::UNARY_OPERATION:
+            return self.visit_node(node_cast<Ast_Unary_Operation>(node));
+        case Ast_Node_Type::BINARY_OPERATION:
+            return self.visit_node(node_cast<Ast_Binary_Operation>(node));
+        case Ast_Node_Type::GROUPING_EXPRESSION:
+            return self.visit_node(node_cast<Ast_Grouping_Expression>(node));
+        case Ast_Node_Type::CAST:
+            return self.visit_node(node_cast<Ast_Cast>(node));
+        case Ast_Node_Type::FUNCTION_DECLARATION:
+            return self.visit_node(node_cast<Ast_Func_Decl>(node));
+        case Ast_Node_Type::FUNCTION_CALL:
+            return self.visit_node(node_cast<Ast_Func_Call>(node));
+        case Ast_Node_Type::RETURN:
+            return self.visit_node(node_cast<Ast_Return>(node));
+        case Ast_Node_Type::VARIABLE_DECLARATION:
+            return self.visit_node(node_cast<Ast_Var_Decl>(node));
+        case Ast_Node_Type::IF:
+            return self.visit_node(node_cast<Ast_If>(node));
+        case Ast_Node_Type::WHILE:
+            return self.visit_node(node_cast<Ast_While>(node));
+        case Ast_Node_Type::DO_WHILE:
+            return self.visit_node(node_cast<Ast_Do_While>(node));
+        case Ast_Node_Type::FOR:
+            return self.visit_node(node_cast<Ast_For>(node));
+        case Ast_Node_Type::BREAK:
+            return self.visit_node(node_cast<Ast_Break>(node));
+        case Ast_Node_Type::CONTINUE:
+            return self.visit_node(node_cast<Ast_Continue>(node));
+        case Ast_Node_Type::STRUCT:
+            return self.visit_node(node_cast<Ast_Struct>(node));
+        case Ast_Node_Type::ENUM:
+            return self.visit_node(node_cast<Ast_Enum>(node));
+        case Ast_Node_Type::UNION:
+            return self.visit_node(node_cast<Ast_Union_Decl>(node));
+        case Ast_Node_Type::ARRAY_ACCESS:
+            return self.visit_node(node_cast<Ast_Array_Access>(node));
+        case Ast_Node_Type::MEMBER_ACCESS:
+            return self.visit_node(node_cast<Ast_Member_Access>(node));
+        case Ast_Node_Type::SCOPE_RESOLUTION:
+            return self.visit_node(node_cast<Ast_Scope_Resolution>(node));
+        case Ast_Node_Type::PTR_DEREFERENCE:
+            return self.visit_node(node_cast<Ast_Ptr_Dereference>(node));
+        case Ast_Node_Type::ADDRESS_OF:
+            return self.visit_node(node_cast<Ast_Address_Of>(node));
+        case Ast_Node_Type::NEW:
+            return self.visit_node(node_cast<Ast_New>(node));
+        case Ast_Node_Type::FREE:
+            return self.visit_node(node_cast<Ast_Free>(node));
+        case Ast_Node_Type::NULL_:
+            return self.visit_node(node_cast<Ast_Null>(node));
+        case Ast_Node_Type::ARRAY_INITIALIZER:
+            return self.visit_node(node_cast<Ast_Array_Initializer>(node));
+        case Ast_Node_Type::POINTER:
+            return self.visit_node(node_cast<Ast_Pointer>(node));
+        case Ast_Node_Type::ARRAY:
+            return self.visit_node(node_cast<Ast_Array>(node));
+        case Ast_Node_Type::INLINE_ASM:
+            return self.visit_node(node_cast<Ast_Inline_Asm>(node));
+        case Ast_Node_Type::UNDEFINED:
+        case Ast_Node_Type::METHOD_DECLARATION:
+            break;
+        }
+        return self.visit_node(node);
+    }
+};
+
+}
+
+#endif //TEZ_AST_VISITOR_H
@@ -0,0 +1,296 @@
+#include "char_scan.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) \
+        && defined(__GNUC__)
+#   define TEZ_SCAN_X86 1
+#   include <immintrin.h>
+#else
+#   define TEZ_SCAN_X86 0
+#endif
+
+namespace tez {
+
+namespace {
+
+namespace scalar {
+
+const char* skip_whitespace(const char* p) {
+    while(is_whitespace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+const char* skip_identifier(const char* p) {
+    while(is_identifier(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+const char* find_either(const char* p, const char* end, char a, char b) {
+    while(p < end && *p != a && *p != b) {
+        ++p;
+    }
+    return p;
+}
+
+std::size_t count_newlines(const char* p, const char* end,
+        const char*& last_newline) {
+    std::size_t count = 0;
+    for(; p < end; ++p) {
+        if(*p == '\n') {
+            ++count;
+            last_newline = p;
+        }
+    }
+    return count;
+}
+
+}
+
+#if TEZ_SCAN_X86
+
+// Unsigned "x <= limit" for each byte; SSE2 has no unsigned byte compare, but
+// min(x, limit) == x is the same thing.
+
+namespace sse2 {
+
+constexpr std::ptrdiff_t WIDTH = 16;
+
+inline __m128i load(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline __m128i in_range(__m128i v, char low, char count) {
+    const auto shifted = _mm_sub_epi8(v, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(count - 1)),
+            shifted);
+}
+
+inline std::uint32_t mask(__m128i v) {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+}
+
+inline std::uint32_t whitespace_mask(__m128i v) {
+    return mask(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+            in_range(v, '\t', 5)));
+}
+
+inline std::uint32_t identifier_mask(__m128i v) {
+    // Setting bit 0x20 maps upper case letters to lower case ones and no
+    // other byte into 'a'-'z'.
+    const auto letters = in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a',
+            26);
+    const auto digits = in_range(v, '0', 10);
+    const auto underscores = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return mask(_mm_or_si128(_mm_or_si128(letters, digits), underscores));
+}
+
+// Sentinel is neither whitespace nor identifier character, so the loops
+// always stop at it at the latest.
+
+const char* skip_whitespace(const char* p) {
+    for(;; p += WIDTH) {
+        const auto stop = ~whitespace_mask(load(p)) & 0xffffu;
+        if(stop != 0) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+}
+
+const char* skip_identifier(const char* p) {
+    for(;; p += WIDTH) {
+        const auto stop = ~identifier_mask(load(p)) & 0xffffu;
+        if(stop != 0) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+}
+
+const char* find_either(const char* p, const char* end, char a, char b) {
+    const auto va = _mm_set1_epi8(a);
+    const auto vb = _mm_set1_epi8(b);
+    for(; end - p >= WIDTH; p += WIDTH) {
+        const auto v = load(p);
+        const auto found = mask(_mm_or_si128(_mm_cmpeq_epi8(v, va),
+                _mm_cmpeq_epi8(v, vb)));
+        if(found != 0) {
+            return p + __builtin_ctz(found);
+        }
+    }
+    return scalar::find_either(p, end, a, b);
+}
+
+std::size_t count_newlines(const char* p, const char* end,
+        const char*& last_newline) {
+    const auto newline = _mm_set1_epi8('\n');
+    std::size_t count = 0;
+    for(; end - p >= WIDTH; p += WIDTH) {
+        const auto found = mask(_mm_cmpeq_epi8(load(p), newline));
+        if(found != 0) {
+            count += __builtin_popcount(found);
+            last_newline = p + 31 - __builtin_clz(found);
+        }
+    }
+    return count + scalar::count_newlines(p, end, last_newline);
+}
+
+}
+
+#define TEZ_AVX2 __attribute__((target("avx2")))
+
+namespace avx2 {
+
+constexpr std::ptrdiff_t WIDTH = 32;
+
+TEZ_AVX2 inline __m256i load(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+TEZ_AVX2 inline __m256i in_range(__m256i v, char low, char count) {
+    const auto shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(
+            _mm256_min_epu8(shifted, _mm256_set1_epi8(count - 1)), shifted);
+}
+
+TEZ_AVX2 inline std::uint32_t mask(__m256i v) {
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+}
+
+TEZ_AVX2 inline std::uint32_t whitespace_mask(__m256i v) {
+    return mask(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+            in_range(v, '\t', 5)));
+}
+
+TEZ_AVX2 inline std::uint32_t identifier_mask(__m256i v) {
+    const auto letters = in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)),
+            'a', 26);
+    const auto digits = in_range(v, '0', 10);
+    const auto underscores = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return mask(_mm256_or_si256(_mm256_or_si256(letters, digits),
+            underscores));
+}
+
+TEZ_AVX2 const char* skip_whitespace(const char* p) {
+    for(;; p += WIDTH) {
+        const auto stop = ~whitespace_mask(load(p));
+        if(stop != 0) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+}
+
+TEZ_AVX2 const char* skip_identifier(const char* p) {
+    for(;; p += WIDTH) {
+        const auto stop = ~identifier_mask(load(p));
+        if(stop != 0) {
+            return p + __builtin_ctz(stop);
+        }
+    }
+}
+
+TEZ_AVX2 const char* find_either(const char* p, const char* end, char a,
+        char b) {
+    const auto va = _mm256_set1_epi8(a);
+    const auto vb = _mm256_set1_epi8(b);
+    for(; end - p >= WIDTH; p += WIDTH) {
+        const auto v = load(p);
+        const auto found = mask(_mm256_or_si256(_mm256_cmpeq_epi8(v, va),
+                _mm256_cmpeq_epi8(v, vb)));
+        if(found != 0) {
+            return p + __builtin_ctz(found);
+        }
+    }
+    return sse2::find_either(p, end, a, b);
+}
+
+TEZ_AVX2 std::size_t count_newlines(const char* p, const char* end,
+        const char*& last_newline) {
+    const auto newline = _mm256_set1_epi8('\n');
+    std::size_t count = 0;
+    for(; end - p >= WIDTH; p += WIDTH) {
+        const auto found = mask(_mm256_cmpeq_epi8(load(p), newline));
+        if(found != 0) {
+            count += __builtin_popcount(found);
+            last_newline = p + 31 - __builtin_clz(found);
+        }
+    }
+    return count + sse2::count_newlines(p, end, last_newline);
+}
+
+}
+
+#undef TEZ_AVX2
+
+#endif // TEZ_SCAN_X86
+
+const Scan_Functions SCALAR_FUNCTIONS{
+        scalar::skip_whitespace,
+        scalar::skip_identifier,
+        scalar::find_either,
+        scalar::count_newlines,
+};
+
+#if TEZ_SCAN_X86
+const Scan_Functions SSE2_FUNCTIONS{
+        sse2::skip_whitespace,
+        sse2::skip_identifier,
+        sse2::find_either,
+        sse2::count_newlines,
+};
+
+const Scan_Functions AVX2_FUNCTIONS{
+        avx2::skip_whitespace,
+        avx2::skip_identifier,
+        avx2::find_either,
+        avx2::count_newlines,
+};
+#endif
+
+const Scan_Functions& best_functions() {
+    static const Scan_Functions& functions = scan_functions(best_scan_isa());
+    return functions;
+}
+
+}
+
+Scan_Isa best_scan_isa() {
+#if TEZ_SCAN_X86
+    if(__builtin_cpu_supports("avx2")) {
+        return Scan_Isa::AVX2;
+    }
+    return Scan_Isa::SSE2;
+#else
+    return Scan_Isa::SCALAR;
+#endif
+}
+
+const Scan_Functions& scan_functions(Scan_Isa isa) {
+    switch(isa) {
+#if TEZ_SCAN_X86
+        case Scan_Isa::AVX2: return AVX2_FUNCTIONS;
+        case Scan_Isa::SSE2: return SSE2_FUNCTIONS;
+#endif
+        default:             return SCALAR_FUNCTIONS;
+    }
+}
+
+const char* skip_whitespace(const char* begin) {
+    return best_functions().skip_whitespace(begin);
+}
+
+const char* skip_identifier(const char* begin) {
+    return best_functions().skip_identifier(begin);
+}
+
+const char* find_either(const char* begin, const char* end, char a, char b) {
+    return best_functions().find_either(begin, end, a, b);
+}
+
+std::size_t count_newlines(const char* begin, const char* end,
+        const char*& last_newline) {
+    return best_functions().count_newlines(begin, end, last_newline);
+}
+
+}
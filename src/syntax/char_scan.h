@@ -0,0 +1,110 @@
+#ifndef TEZ_CHAR_SCAN_H
+#define TEZ_CHAR_SCAN_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tez {
+
+// Locale independent character classes; <cctype> functions depend on
+// current locale and are called through PLT on every character.
+namespace char_class {
+
+constexpr std::uint8_t WHITESPACE = 1 << 0;  // ' ' \t \n \v \f \r
+constexpr std::uint8_t DIGIT      = 1 << 1;  // 0-9
+constexpr std::uint8_t ALPHA      = 1 << 2;  // a-z A-Z _
+constexpr std::uint8_t PUNCT      = 1 << 3;  // ASCII punctuation except _
+
+constexpr std::array<std::uint8_t, 256> make_table() {
+    std::array<std::uint8_t, 256> table{};
+    for(int c = 0; c < 256; ++c) {
+        std::uint8_t cls = 0;
+        if(c == ' ' || (c >= '\t' && c <= '\r')) {
+            cls |= WHITESPACE;
+        }
+        if(c >= '0' && c <= '9') {
+            cls |= DIGIT;
+        }
+        if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+            cls |= ALPHA;
+        }
+        if(c > ' ' && c < 0x7f && !(cls & (DIGIT | ALPHA))) {
+            cls |= PUNCT;
+        }
+        table[c] = cls;
+    }
+    return table;
+}
+
+inline constexpr std::array<std::uint8_t, 256> TABLE = make_table();
+
+}
+
+inline bool is_whitespace(char c) {
+    return char_class::TABLE[static_cast<unsigned char>(c)]
+            & char_class::WHITESPACE;
+}
+
+inline bool is_digit(char c) {
+    return char_class::TABLE[static_cast<unsigned char>(c)] & char_class::DIGIT;
+}
+
+inline bool is_identifier_start(char c) {
+    return char_class::TABLE[static_cast<unsigned char>(c)] & char_class::ALPHA;
+}
+
+inline bool is_identifier(char c) {
+    return char_class::TABLE[static_cast<unsigned char>(c)]
+            & (char_class::ALPHA | char_class::DIGIT);
+}
+
+inline bool is_punct(char c) {
+    return char_class::TABLE[static_cast<unsigned char>(c)] & char_class::PUNCT;
+}
+
+// Vectorized scanning. Each function returns pointer to the first character
+// that stops the scan. Best implementation available on running CPU (AVX2,
+// SSE2 or scalar) is selected on first use.
+
+// Skip functions don't take end of text: they rely on NUL sentinel (which is
+// never skipped) and may read up to SCAN_OVERREAD bytes past it, like
+// Source_Buffer allows.
+constexpr std::size_t SCAN_OVERREAD = 32;
+
+// Skip run of whitespace characters.
+const char* skip_whitespace(const char* begin);
+// Skip run of identifier characters (letters, digits and underscores).
+const char* skip_identifier(const char* begin);
+
+// Functions below scan [begin, end) and return end if nothing was found.
+
+// Find first occurrence of any of two characters.
+const char* find_either(const char* begin, const char* end, char a, char b);
+// Count '\n' characters; position of last one is stored in last_newline
+// (untouched if there are no newlines).
+std::size_t count_newlines(const char* begin, const char* end,
+        const char*& last_newline);
+
+enum class Scan_Isa {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+struct Scan_Functions {
+    const char* (*skip_whitespace)(const char*);
+    const char* (*skip_identifier)(const char*);
+    const char* (*find_either)(const char*, const char*, char, char);
+    std::size_t (*count_newlines)(const char*, const char*, const char*&);
+};
+
+// Best instruction set supported by running CPU.
+Scan_Isa best_scan_isa();
+// Implementation for given instruction set; used by tests to compare them.
+// Caller has to make sure CPU supports it.
+const Scan_Functions& scan_functions(Scan_Isa isa);
+
+}
+
+#endif //TEZ_CHAR_SCAN_H
@@ -0,0 +1,137 @@
+#include "diagnostics.h"
+
+#include <algorithm>
+
+namespace tez {
+
+namespace {
+
+const char* severity_name(Severity severity) {
+    switch(severity) {
+    case Severity::NOTE:
+        return "note";
+    case Severity::WARNING:
+        return "warning";
+    case Severity::ERROR:
+        return "error";
+    }
+    return "";
+}
+
+// Quote character, escaping ones that aren't printable.
+std::string quoted(std::uint32_t c) {
+    constexpr char HEX[] = "0123456789abcdef";
+    if(c >= ' ' && c <= '~') {
+        return std::string{'\'', static_cast<char>(c), '\''};
+    }
+    return std::string{'\'', '\\', 'x', HEX[(c >> 4) & 0xf], HEX[c & 0xf],
+            '\''};
+}
+
+std::string token_name(std::uint32_t type) {
+    return to_string(static_cast<Token_Type>(type));
+}
+
+}
+
+Diagnostics::Diagnostics(std::size_t error_limit)
+        : _error_limit{error_limit} {
+}
+
+bool Diagnostics::report(Severity severity, Diagnostic_Id id, File_Id file,
+        std::uint32_t offset, std::uint32_t arg0, std::uint32_t arg1) {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return record({id, severity, file, offset, {arg0, arg1}});
+}
+
+bool Diagnostics::report(Severity severity, std::string text) {
+    // Text is stored only if diagnostic is, in the same critical section, so
+    // flush() can't separate them. Diagnostics without source location
+    // (NO_FILE) are printed after all files.
+    std::lock_guard<std::mutex> lock{_mutex};
+    const auto index = static_cast<std::uint32_t>(_texts.size());
+    if(!record({Diagnostic_Id::TEXT, severity, NO_FILE, 0, {index, 0}})) {
+        return false;
+    }
+    _texts.push_back(std::move(text));
+    return true;
+}
+
+bool Diagnostics::record(const Diagnostic& diagnostic) {
+    if(diagnostic.severity == Severity::ERROR) {
+        if(_limit_reached.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        const auto count = _error_count.load(std::memory_order_relaxed) + 1;
+        _error_count.store(count, std::memory_order_relaxed);
+        if(_error_limit != 0 && count >= _error_limit) {
+            _limit_reached.store(true, std::memory_order_relaxed);
+        }
+    }
+    _diagnostics.push_back(diagnostic);
+    return true;
+}
+
+void Diagnostics::flush(const File_Table& files, std::ostream& out) {
+    std::lock_guard<std::mutex> lock{_mutex};
+    std::stable_sort(_diagnostics.begin(), _diagnostics.end(),
+            [](const Diagnostic& a, const Diagnostic& b) {
+                return a.file != b.file ? a.file < b.file
+                        : a.offset < b.offset;
+            });
+    std::string buffer;
+    for(const auto& diagnostic : _diagnostics) {
+        if(diagnostic.file != NO_FILE) {
+            const auto location = files.location(diagnostic.file,
+                    diagnostic.offset);
+            buffer += files.path(diagnostic.file);
+            buffer += ':';
+            buffer += std::to_string(location.line);
+            buffer += ':';
+            buffer += std::to_string(location.column);
+            buffer += ": ";
+        }
+        buffer += severity_name(diagnostic.severity);
+        buffer += ": ";
+        buffer += message(diagnostic);
+        buffer += ".\n";
+    }
+    if(_limit_reached.load(std::memory_order_relaxed) && !_limit_noted) {
+        buffer += "note: Too many errors, stopping now.\n";
+        _limit_noted = true;
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+    _diagnostics.clear();
+    _texts.clear();
+}
+
+std::string Diagnostics::message(const Diagnostic& diagnostic) const {
+    const auto* args = diagnostic.args;
+    switch(diagnostic.id) {
+    case Diagnostic_Id::UNEXPECTED_CHARACTER:
+        return "Unexpected character " + quoted(args[0]);
+    case Diagnostic_Id::UNEXPECTED_END_OF_FILE:
+        return "Unexpected end of file";
+    case Diagnostic_Id::UNKNOWN_OPERATOR:
+        return "Unknown operator " + quoted(args[0]);
+    case Diagnostic_Id::TOO_MANY_DECIMAL_POINTS:
+        return "Too many decimal points in number";
+    case Diagnostic_Id::EXPECTED_QUOTE:
+        return "Expected ''', got " + quoted(args[0]);
+    case Diagnostic_Id::EXPECTED_TOKEN:
+        return "Expected " + token_name(args[0]) + ", got "
+                + token_name(args[1]);
+    case Diagnostic_Id::EXPECTED_PRIMARY_EXPRESSION:
+        return "Expected primary expression, got " + token_name(args[0]);
+    case Diagnostic_Id::EXPECTED_FUNCTION_NAME:
+        return "Expected function name before '('";
+    case Diagnostic_Id::MISSING_CLOSING_BRACE:
+        return "Missing closing '}'";
+    case Diagnostic_Id::TEXT:
+        return _texts[args[0]];
+    }
+    return "";
+}
+
+}
@@ -0,0 +1,96 @@
+#ifndef TEZ_DIAGNOSTICS_H
+#define TEZ_DIAGNOSTICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "syntax/file_table.h"
+#include "syntax/token.h"
+
+namespace tez {
+
+enum class Severity : std::uint8_t {
+    NOTE,
+    WARNING,
+    ERROR,
+};
+
+// Every message compiler can report. Text is produced only when diagnostics
+// are printed, see Diagnostics::message().
+enum class Diagnostic_Id : std::uint8_t {
+    // Lexer.
+    UNEXPECTED_CHARACTER,       // args[0]: character.
+    UNEXPECTED_END_OF_FILE,
+    UNKNOWN_OPERATOR,           // args[0]: character.
+    TOO_MANY_DECIMAL_POINTS,
+    EXPECTED_QUOTE,             // args[0]: character found instead.
+    // Parser.
+    EXPECTED_TOKEN,             // args[0]: expected, args[1]: got (Token_Type).
+    EXPECTED_PRIMARY_EXPRESSION,// args[0]: got (Token_Type).
+    EXPECTED_FUNCTION_NAME,
+    MISSING_CLOSING_BRACE,
+    // Anything without source location (driver errors); args[0] indexes
+    // free-form texts.
+    TEXT,
+};
+
+// 16 bytes, no strings; arguments are interpreted according to id.
+struct Diagnostic {
+    Diagnostic_Id id;
+    Severity      severity;
+    File_Id       file;
+    std::uint32_t offset;
+    std::uint32_t args[2];
+};
+
+// Collects diagnostics of one compilation phase and prints them at once.
+// Reporting is thread safe, so one instance is shared by all files compiled
+// in parallel. After error limit is reached, further errors are dropped and
+// report() returns false; lexer and parser then stop early.
+class Diagnostics {
+public:
+    // Error limit 0 means no limit.
+    explicit Diagnostics(std::size_t error_limit = 0);
+    Diagnostics(const Diagnostics&) = delete;
+    Diagnostics& operator=(const Diagnostics&) = delete;
+
+    // Returns false if diagnostic was dropped due to error limit.
+    bool report(Severity severity, Diagnostic_Id id, File_Id file,
+            std::uint32_t offset, std::uint32_t arg0 = 0,
+            std::uint32_t arg1 = 0);
+    bool report(Severity severity, std::string text);
+
+    // Print everything reported since last flush in single write. Diagnostics
+    // are sorted by file id and offset; lexer runs ahead of parser, so order
+    // of reporting isn't order in source.
+    void flush(const File_Table& files, std::ostream& out);
+
+    std::size_t error_count() const {
+        return _error_count.load(std::memory_order_relaxed);
+    }
+    bool limit_reached() const {
+        return _limit_reached.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Both expect _mutex to be locked.
+    bool record(const Diagnostic& diagnostic);
+    // Format message of diagnostic, without location and severity.
+    std::string message(const Diagnostic& diagnostic) const;
+
+    const std::size_t        _error_limit;
+    std::mutex               _mutex;
+    std::vector<Diagnostic>  _diagnostics;
+    std::vector<std::string> _texts;
+    std::atomic<std::size_t> _error_count{0};
+    std::atomic<bool>        _limit_reached{false};
+    bool                     _limit_noted = false;
+};
+
+}
+
+#endif //TEZ_DIAGNOSTICS_H
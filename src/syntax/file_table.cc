@@ -0,0 +1,69 @@
+#include "file_table.h"
+
+#include "char_scan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace tez {
+
+File_Id File_Table::open(const std::string& path) {
+    return push(path, Source_Buffer::from_file(path));
+}
+
+File_Id File_Table::add(const std::string& name, std::string_view content) {
+    return push(name, Source_Buffer::from_string(content));
+}
+
+void File_Table::edit(File_Id id, const Text_Edit& edit) {
+    const auto source = this->source(id);
+    if(edit.offset > source.size()
+            || edit.removed > source.size() - edit.offset) {
+        throw std::out_of_range{"Edit is outside of file \""
+                + path(id) + "\"."};
+    }
+    if(source.size() - edit.removed + edit.inserted.size()
+            > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{"Source file \"" + path(id) + "\" is too big."};
+    }
+    auto buffer = Source_Buffer::from_strings({source.substr(0, edit.offset),
+            edit.inserted, source.substr(edit.offset + edit.removed)});
+    auto lines = std::make_unique<Line_Index>();
+    _files[id].buffer = std::move(buffer);
+    _files[id].lines = std::move(lines);
+}
+
+File_Id File_Table::push(std::string path, Source_Buffer&& buffer) {
+    if(_files.size() >= NO_FILE) {
+        throw std::length_error{"Too many source files."};
+    }
+    if(buffer.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{"Source file \"" + path + "\" is too big."};
+    }
+    _files.emplace_back(std::move(path), std::move(buffer));
+    return static_cast<File_Id>(_files.size() - 1);
+}
+
+Source_Location File_Table::location(File_Id id, std::uint32_t offset) const {
+    const auto& file = _files[id];
+    auto& lines = *file.lines;
+    std::call_once(lines.built, [&file, &lines] {
+        const char* begin = file.buffer.data();
+        const char* end = begin + file.buffer.size();
+        const char* last_newline = nullptr;
+        lines.starts.reserve(count_newlines(begin, end, last_newline) + 1);
+        lines.starts.push_back(0);
+        for(const char* p = begin; (p = static_cast<const char*>(
+                std::memchr(p, '\n', end - p))) != nullptr; ++p) {
+            lines.starts.push_back(static_cast<std::uint32_t>(p - begin + 1));
+        }
+    });
+    const auto& starts = lines.starts;
+    const auto line = std::upper_bound(starts.begin(), starts.end(), offset) - 1;
+    return {static_cast<std::uint32_t>(line - starts.begin() + 1),
+            offset - *line + 1};
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef TEZ_FILE_TABLE_H
+#define TEZ_FILE_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "syntax/source_buffer.h"
+#include "syntax/token.h"
+
+namespace tez {
+
+struct Source_Location {
+    std::uint32_t line;     // Both are counted from 1.
+    std::uint32_t column;
+};
+
+// Bytes [begin, end) of a file.
+struct Source_Range {
+    std::uint32_t begin;
+    std::uint32_t end;
+};
+
+// Replace `removed` bytes starting at offset with inserted text.
+struct Text_Edit {
+    std::uint32_t    offset;
+    std::uint32_t    removed;
+    std::string_view inserted;
+};
+
+// Offsets where lines begin. Only diagnostics need them, so they're computed
+// on first use (see File_Table::location()).
+struct Line_Index {
+    std::vector<std::uint32_t> starts;
+    std::once_flag             built;
+};
+
+struct Source_File {
+    Source_File(std::string path, Source_Buffer&& buffer)
+            : path{std::move(path)}, buffer{std::move(buffer)} {}
+
+    std::string   path;
+    Source_Buffer buffer;
+    // Replaced with empty one when buffer changes.
+    mutable std::unique_ptr<Line_Index> lines = std::make_unique<Line_Index>();
+};
+
+// Owns source buffers of all files in compilation. Tokens refer to their file
+// through File_Id and to their lexeme through offset and length, so the table
+// has to outlive every token and AST node created from its files.
+class File_Table {
+public:
+    // Load file from disk ("-" means stdin). Throws File_Not_Found.
+    File_Id open(const std::string& path);
+    // Register source code that doesn't come from file (tests, tools).
+    File_Id add(const std::string& name, std::string_view content);
+    // Replace part of file's source; used when file changes in editor. Tokens
+    // of the file are invalidated, AST doesn't point into source. Not thread
+    // safe, no one else may use the file meanwhile.
+    void edit(File_Id id, const Text_Edit& edit);
+
+    const Source_File& file(File_Id id) const { return _files[id]; }
+    const std::string& path(File_Id id) const { return _files[id].path; }
+    std::string_view source(File_Id id) const { return _files[id].buffer.view(); }
+
+    // Get text of given token.
+    std::string_view lexeme(const Token& token) const {
+        return source(token.file).substr(token.offset, token.length);
+    }
+
+    // Translate offset into line and column. First call for a file scans it
+    // for newlines, later ones are just binary search. Thread safe.
+    Source_Location location(File_Id id, std::uint32_t offset) const;
+    Source_Location location(const Token& token) const {
+        return location(token.file, token.offset);
+    }
+
+    std::size_t size() const { return _files.size(); }
+
+private:
+    // Throws std::length_error when table is full; NO_FILE is never given.
+    File_Id push(std::string path, Source_Buffer&& buffer);
+
+    // Deque, because references to files must stay valid when adding new ones.
+    std::deque<Source_File> _files;
+};
+
+}
+
+#endif //TEZ_FILE_TABLE_H
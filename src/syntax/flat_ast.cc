@@ -0,0 +1,583 @@
+#include "flat_ast.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "syntax/ast_visitor.h"
+
+namespace tez {
+
+namespace {
+
+void split(std::uint64_t bits, Flat_Node& node) {
+    node.data[0] = static_cast<std::uint32_t>(bits);
+    node.data[1] = static_cast<std::uint32_t>(bits >> 32);
+}
+
+std::uint64_t join(const Flat_Node& node) {
+    return node.data[0] | static_cast<std::uint64_t>(node.data[1]) << 32;
+}
+
+// Children of node that are Ast_Nodes, in order in which Flattener expects
+// their indices. Null children are kept.
+class Child_Collector final : public Ast_Visitor<Child_Collector, void> {
+public:
+    explicit Child_Collector(std::vector<const Ast_Node*>& children)
+            : _children{children} {}
+
+    void visit_node(const Ast_File& node) { add(node.statements); }
+    void visit_node(const Ast_Block& node) { add(node.statements); }
+    void visit_node(const Ast_Namespace& node) { add({&node.body}); }
+    void visit_node(const Ast_Unary_Operation& node) { add({node.left}); }
+    void visit_node(const Ast_Binary_Operation& node) {
+        add({node.left, node.right});
+    }
+    void visit_node(const Ast_Grouping_Expression& node) { add({node.expr}); }
+    void visit_node(const Ast_Cast& node) { add({node.expr, node.to}); }
+    void visit_node(const Ast_Address_Of& node) { add({node.expr}); }
+    void visit_node(const Ast_Func_Decl& node) {
+        add({node.return_type, &node.body});
+        for(const auto& param : node.params) {
+            _children.push_back(param.type);
+        }
+    }
+    void visit_node(const Ast_Return& node) { add({node.expr}); }
+    void visit_node(const Ast_Func_Call& node) { add(node.args); }
+    void visit_node(const Ast_Var_Decl& node) {
+        add({node.type, node.initializer});
+    }
+    void visit_node(const Ast_If& node) {
+        add({node.condition, &node.if_block, node.else_block});
+    }
+    void visit_node(const Ast_While& node) {
+        add({node.condition, &node.body});
+    }
+    void visit_node(const Ast_Do_While& node) {
+        add({node.condition, &node.body});
+    }
+    void visit_node(const Ast_For& node) {
+        add({node.init_statement, node.condition, node.iteration_expr,
+                &node.body});
+    }
+    void visit_node(const Ast_Struct& node) {
+        for(const auto& field : node.fields) {
+            _children.push_back(field.type);
+        }
+    }
+    void visit_node(const Ast_Union_Decl& node) {
+        for(const auto& member : node.members) {
+            _children.push_back(member.type);
+        }
+    }
+    void visit_node(const Ast_Array_Access& node) {
+        add({node.array, node.at});
+    }
+    void visit_node(const Ast_Member_Access& node) {
+        add({node.left, node.right});
+    }
+    void visit_node(const Ast_Scope_Resolution& node) {
+        add({node.left, node.right});
+    }
+    void visit_node(const Ast_Ptr_Dereference& node) { add({node.expr}); }
+    void visit_node(const Ast_New& node) { add({node.type}); }
+    void visit_node(const Ast_Free& node) { add({node.what}); }
+    void visit_node(const Ast_Array_Initializer& node) { add(node.values); }
+    void visit_node(const Ast_Pointer& node) { add({node.expr}); }
+    void visit_node(const Ast_Array& node) { add({node.type, node.size}); }
+    // Leaves.
+    void visit_node([[maybe_unused]] const Ast_Node& node) {}
+
+private:
+    template<typename List>
+    void add(const List& nodes) {
+        for(const auto& node : nodes) {
+            _children.push_back(node);
+        }
+    }
+    void add(std::initializer_list<const Ast_Node*> nodes) {
+        _children.insert(_children.end(), nodes);
+    }
+
+    std::vector<const Ast_Node*>& _children;
+};
+
+// Appends node to Flat_Ast once indices of its children (see Child_Collector)
+// are known.
+class Flattener final : public Ast_Visitor<Flattener, Node_Index> {
+public:
+    explicit Flattener(Flat_Ast& ast) : _ast{ast} {}
+
+    Node_Index flatten(const Ast_Node& node, const Node_Index* children) {
+        _children = children;
+        return visit(node);
+    }
+
+    Node_Index visit_node(const Ast_File& node) {
+        return add(Ast_Node_Type::FILE, 0, add_list(node.statements.size()),
+                node.statements.size());
+    }
+    Node_Index visit_node(const Ast_Block& node) {
+        return add(Ast_Node_Type::BLOCK, 0, add_list(node.statements.size()),
+                node.statements.size());
+    }
+    Node_Index visit_node(const Ast_Namespace& node) {
+        return add(Ast_Node_Type::NAMESPACE, 0, text(node.name), _children[0]);
+    }
+    Node_Index visit_node(const Ast_Using& node) {
+        return add(Ast_Node_Type::USING, 0, text(node.nspace),
+                text(node.alias));
+    }
+    Node_Index visit_node(const Ast_Boolean& node) {
+        return add(Ast_Node_Type::BOOLEAN, node.value);
+    }
+    Node_Index visit_node(const Ast_Integer& node) {
+        return integer(node.value);
+    }
+    Node_Index visit_node(const Ast_Real_Number& node) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &node.value, sizeof(bits));
+        auto& flat = _ast.nodes.emplace_back(
+                Flat_Node{Ast_Node_Type::REAL_NUMBER});
+        split(bits, flat);
+        return static_cast<Node_Index>(_ast.nodes.size() - 1);
+    }
+    Node_Index visit_node(const Ast_String& node) {
+        return add(Ast_Node_Type::STRING, 0, text(node.value));
+    }
+    Node_Index visit_node(const Ast_Identifier& node) {
+        return add(Ast_Node_Type::IDENTIFIER, 0, text(node.name));
+    }
+    Node_Index visit_node(const Ast_Unary_Operation& node) {
+        return add(Ast_Node_Type::UNARY_OPERATION,
+                static_cast<std::uint8_t>(node.operat), _children[0]);
+    }
+    Node_Index visit_node(const Ast_Binary_Operation& node) {
+        return add(Ast_Node_Type::BINARY_OPERATION,
+                static_cast<std::uint8_t>(node.operat), _children[0],
+                _children[1]);
+    }
+    Node_Index visit_node(const Ast_Func_Decl& node) {
+        // Parameters are emitted right before function, after their types.
+        _list.clear();
+        _list.push_back(node.parent == Atom{} ? NO_NODE : text(node.parent));
+        _list.insert(_list.end(), _children, _children + 2);
+        for(std::size_t i = 0; i < node.params.size(); ++i) {
+            const auto& param = node.params[i];
+            _list.push_back(add(Ast_Node_Type::VARIABLE_DECLARATION,
+                    param.constant, text(param.name), _children[2 + i],
+                    NO_NODE));
+        }
+        return add(Ast_Node_Type::FUNCTION_DECLARATION, 0, text(node.name),
+                append_list(), _list.size());
+    }
+    Node_Index visit_node(const Ast_Func_Call& node) {
+        return add(Ast_Node_Type::FUNCTION_CALL, 0, text(node.name),
+                add_list(node.args.size()), node.args.size());
+    }
+    Node_Index visit_node(const Ast_Var_Decl& node) {
+        return add(Ast_Node_Type::VARIABLE_DECLARATION, node.constant,
+                text(node.name), _children[0], _children[1]);
+    }
+    Node_Index visit_node(const Ast_For&) {
+        return add(Ast_Node_Type::FOR, 0, add_list(4));
+    }
+    Node_Index visit_node(const Ast_Struct& node) {
+        return members(Ast_Node_Type::STRUCT, node.name, node.fields);
+    }
+    Node_Index visit_node(const Ast_Union_Decl& node) {
+        return members(Ast_Node_Type::UNION, node.name, node.members);
+    }
+    Node_Index visit_node(const Ast_Enum& node) {
+        _list.clear();
+        for(const auto& enumerator : node.enumerations) {
+            const auto value = integer(enumerator.value);
+            _list.push_back(add(Ast_Node_Type::VARIABLE_DECLARATION, 0,
+                    text(enumerator.name), NO_NODE, value));
+        }
+        return add(Ast_Node_Type::ENUM, 0, text(node.name), append_list(),
+                _list.size());
+    }
+    Node_Index visit_node(const Ast_Array_Initializer& node) {
+        return add(Ast_Node_Type::ARRAY_INITIALIZER, 0,
+                add_list(node.values.size()), node.values.size());
+    }
+    Node_Index visit_node(const Ast_Inline_Asm& node) {
+        _list.clear();
+        for(const auto& operation : node.operations) {
+            _list.push_back(text(operation));
+        }
+        return add(Ast_Node_Type::INLINE_ASM, 0, append_list(), _list.size());
+    }
+    // Remaining nodes have fixed number of children, copied to data in order.
+    Node_Index visit_node(const Ast_Node& node) {
+        _children_collected.clear();
+        Child_Collector{_children_collected}.visit(node);
+        Flat_Node flat{node.node_type};
+        std::copy(_children, _children + _children_collected.size(), flat.data);
+        _ast.nodes.push_back(flat);
+        return static_cast<Node_Index>(_ast.nodes.size() - 1);
+    }
+
+private:
+    Node_Index add(Ast_Node_Type type, std::uint8_t flags,
+            std::uint32_t d0 = 0, std::uint32_t d1 = 0, std::uint32_t d2 = 0) {
+        _ast.nodes.push_back({type, flags, 0, {d0, d1, d2}});
+        return static_cast<Node_Index>(_ast.nodes.size() - 1);
+    }
+
+    Node_Index integer(std::int64_t value) {
+        auto& flat = _ast.nodes.emplace_back(Flat_Node{Ast_Node_Type::INTEGER});
+        split(static_cast<std::uint64_t>(value), flat);
+        return static_cast<Node_Index>(_ast.nodes.size() - 1);
+    }
+
+    // First count children become list.
+    std::uint32_t add_list(std::size_t count) {
+        const auto first = static_cast<std::uint32_t>(_ast.lists.size());
+        _ast.lists.insert(_ast.lists.end(), _children, _children + count);
+        return first;
+    }
+    std::uint32_t append_list() {
+        const auto first = static_cast<std::uint32_t>(_ast.lists.size());
+        _ast.lists.insert(_ast.lists.end(), _list.begin(), _list.end());
+        return first;
+    }
+
+    template<typename Members>
+    Node_Index members(Ast_Node_Type type, Atom name, const Members& members) {
+        _list.clear();
+        std::size_t i = 0;
+        for(const auto& member : members) {
+            _list.push_back(add(Ast_Node_Type::VARIABLE_DECLARATION, 0,
+                    text(member.name), _children[i++], NO_NODE));
+        }
+        return add(type, 0, text(name), append_list(), _list.size());
+    }
+
+    // Names are stored once, string literals every time.
+    std::uint32_t text(Atom atom) {
+        const auto [it, inserted] = _names.try_emplace(atom, 0);
+        if(inserted) {
+            it->second = text(atom_name(atom));
+        }
+        return it->second;
+    }
+    std::uint32_t text(std::string_view s) {
+        _ast.texts.push_back({static_cast<std::uint32_t>(_ast.chars.size()),
+                static_cast<std::uint32_t>(s.size())});
+        _ast.chars += s;
+        return static_cast<std::uint32_t>(_ast.texts.size() - 1);
+    }
+
+    Flat_Ast&                                _ast;
+    const Node_Index*                        _children = nullptr;
+    std::vector<Node_Index>                  _list;
+    std::vector<const Ast_Node*>             _children_collected;
+    std::unordered_map<Atom, std::uint32_t>  _names;
+};
+
+// Header of serialized Flat_Ast.
+struct Sizes {
+    std::uint64_t nodes;
+    std::uint64_t lists;
+    std::uint64_t texts;
+    std::uint64_t chars;
+    std::uint64_t root;
+};
+
+template<typename T>
+void append(std::string& out, const T* data, std::size_t count) {
+    out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+template<typename T>
+void read(std::string_view& in, T* data, std::size_t count) {
+    std::memcpy(data, in.data(), count * sizeof(T));
+    in.remove_prefix(count * sizeof(T));
+}
+
+[[noreturn]] void corrupted() {
+    throw std::invalid_argument{"Serialized AST is corrupted."};
+}
+
+// Check every index against its table and that children come before their
+// parents (see layout at Flat_Node), so corrupted data can't make users of
+// Flat_Ast read out of bounds or loop forever.
+void check_indices(const Flat_Ast& ast) {
+    for(const auto& text : ast.texts) {
+        if(std::uint64_t{text.offset} + text.length > ast.chars.size()) {
+            corrupted();
+        }
+    }
+    for(Node_Index i = 0; i < ast.nodes.size(); ++i) {
+        const auto& node = ast.nodes[i];
+        const auto& data = node.data;
+        const auto child = [i](Node_Index index) {
+            if(index != NO_NODE && index >= i) {
+                corrupted();
+            }
+        };
+        // Parameters, fields and enumerators are read without checks.
+        const auto member = [&ast, i](Node_Index index) -> const Flat_Node& {
+            if(index >= i || ast.nodes[index].type
+                    != Ast_Node_Type::VARIABLE_DECLARATION) {
+                corrupted();
+            }
+            return ast.nodes[index];
+        };
+        const auto text = [&ast](std::uint32_t index) {
+            if(index >= ast.texts.size()) {
+                corrupted();
+            }
+        };
+        const auto list = [&ast](std::uint32_t first, std::uint32_t count) {
+            if(std::uint64_t{first} + count > ast.lists.size()) {
+                corrupted();
+            }
+            return ast.list(first);
+        };
+        const auto operat = [&node] {
+            if(node.flags > static_cast<std::uint8_t>(Operator::NEGATE)) {
+                corrupted();
+            }
+        };
+        switch(node.type) {
+        case Ast_Node_Type::FILE:
+        case Ast_Node_Type::BLOCK:
+        case Ast_Node_Type::ARRAY_INITIALIZER: {
+            const auto items = list(data[0], data[1]);
+            for(std::uint32_t j = 0; j < data[1]; ++j) {
+                child(items[j]);
+            }
+            break;
+        }
+        case Ast_Node_Type::NAMESPACE:
+            text(data[0]);
+            child(data[1]);
+            break;
+        case Ast_Node_Type::USING:
+            text(data[0]);
+            text(data[1]);
+            break;
+        case Ast_Node_Type::STRING:
+        case Ast_Node_Type::IDENTIFIER:
+            text(data[0]);
+            break;
+        case Ast_Node_Type::UNARY_OPERATION:
+            operat();
+            child(data[0]);
+            break;
+        case Ast_Node_Type::BINARY_OPERATION:
+            operat();
+            child(data[0]);
+            child(data[1]);
+            break;
+        case Ast_Node_Type::GROUPING_EXPRESSION:
+        case Ast_Node_Type::RETURN:
+        case Ast_Node_Type::ADDRESS_OF:
+        case Ast_Node_Type::PTR_DEREFERENCE:
+        case Ast_Node_Type::NEW:
+        case Ast_Node_Type::FREE:
+        case Ast_Node_Type::POINTER:
+            child(data[0]);
+            break;
+        case Ast_Node_Type::CAST:
+        case Ast_Node_Type::WHILE:
+        case Ast_Node_Type::DO_WHILE:
+        case Ast_Node_Type::ARRAY_ACCESS:
+        case Ast_Node_Type::MEMBER_ACCESS:
+        case Ast_Node_Type::SCOPE_RESOLUTION:
+        case Ast_Node_Type::ARRAY:
+            child(data[0]);
+            child(data[1]);
+            break;
+        case Ast_Node_Type::IF:
+            child(data[0]);
+            child(data[1]);
+            child(data[2]);
+            break;
+        case Ast_Node_Type::FUNCTION_DECLARATION: {
+            // Parent, return type, body, parameters.
+            text(data[0]);
+            if(data[2] < 3) {
+                corrupted();
+            }
+            const auto items = list(data[1], data[2]);
+            if(items[0] != NO_NODE) {
+                text(items[0]);
+            }
+            child(items[1]);
+            child(items[2]);
+            for(std::uint32_t j = 3; j < data[2]; ++j) {
+                member(items[j]);
+            }
+            break;
+        }
+        case Ast_Node_Type::FUNCTION_CALL: {
+            text(data[0]);
+            const auto items = list(data[1], data[2]);
+            for(std::uint32_t j = 0; j < data[2]; ++j) {
+                child(items[j]);
+            }
+            break;
+        }
+        case Ast_Node_Type::VARIABLE_DECLARATION:
+            text(data[0]);
+            child(data[1]);
+            child(data[2]);
+            break;
+        case Ast_Node_Type::FOR: {
+            const auto items = list(data[0], 4);
+            for(std::uint32_t j = 0; j < 4; ++j) {
+                child(items[j]);
+            }
+            break;
+        }
+        case Ast_Node_Type::STRUCT:
+        case Ast_Node_Type::UNION:
+        case Ast_Node_Type::ENUM: {
+            text(data[0]);
+            const auto items = list(data[1], data[2]);
+            for(std::uint32_t j = 0; j < data[2]; ++j) {
+                const auto& var = member(items[j]);
+                // Value of enumerator.
+                if(node.type == Ast_Node_Type::ENUM && var.data[2] == NO_NODE) {
+                    corrupted();
+                }
+            }
+            break;
+        }
+        case Ast_Node_Type::INLINE_ASM: {
+            const auto items = list(data[0], data[1]);
+            for(std::uint32_t j = 0; j < data[1]; ++j) {
+                text(items[j]);
+            }
+            break;
+        }
+        case Ast_Node_Type::UNDEFINED:
+        case Ast_Node_Type::METHOD_DECLARATION:
+        case Ast_Node_Type::BOOLEAN:
+        case Ast_Node_Type::INTEGER:
+        case Ast_Node_Type::REAL_NUMBER:
+        case Ast_Node_Type::BREAK:
+        case Ast_Node_Type::CONTINUE:
+        case Ast_Node_Type::NULL_:
+            break;
+        default:
+            corrupted();
+        }
+    }
+}
+
+}
+
+std::int64_t Flat_Ast::integer(const Flat_Node& node) const {
+    return static_cast<std::int64_t>(join(node));
+}
+
+double Flat_Ast::real_number(const Flat_Node& node) const {
+    const auto bits = join(node);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::size_t Flat_Ast::memory() const {
+    return nodes.size() * sizeof(Flat_Node)
+            + lists.size() * sizeof(Node_Index)
+            + texts.size() * sizeof(Flat_Text) + chars.size();
+}
+
+std::string Flat_Ast::serialize() const {
+    const Sizes sizes{nodes.size(), lists.size(), texts.size(), chars.size(),
+            root};
+    std::string out;
+    out.reserve(sizeof(sizes) + memory());
+    append(out, &sizes, 1);
+    append(out, nodes.data(), nodes.size());
+    append(out, lists.data(), lists.size());
+    append(out, texts.data(), texts.size());
+    append(out, chars.data(), chars.size());
+    return out;
+}
+
+Flat_Ast Flat_Ast::deserialize(std::string_view data) {
+    Sizes sizes;
+    if(data.size() < sizeof(sizes)) {
+        throw std::invalid_argument{"Serialized AST is too short."};
+    }
+    read(data, &sizes, 1);
+    // Every count is checked against bytes that are left before multiplying,
+    // sizes in corrupted header may be anything.
+    auto left = data.size();
+    const auto take = [&left](std::uint64_t count, std::size_t size) {
+        if(count > left / size) {
+            throw std::invalid_argument{"Serialized AST has wrong size."};
+        }
+        left -= static_cast<std::size_t>(count) * size;
+    };
+    take(sizes.nodes, sizeof(Flat_Node));
+    take(sizes.lists, sizeof(Node_Index));
+    take(sizes.texts, sizeof(Flat_Text));
+    take(sizes.chars, 1);
+    if(left != 0) {
+        throw std::invalid_argument{"Serialized AST has wrong size."};
+    }
+    if(sizes.root >= sizes.nodes) {
+        throw std::invalid_argument{"Serialized AST has invalid root."};
+    }
+    Flat_Ast ast;
+    ast.nodes.resize(sizes.nodes);
+    ast.lists.resize(sizes.lists);
+    ast.texts.resize(sizes.texts);
+    ast.chars.resize(sizes.chars);
+    ast.root = static_cast<Node_Index>(sizes.root);
+    read(data, ast.nodes.data(), ast.nodes.size());
+    read(data, ast.lists.data(), ast.lists.size());
+    read(data, ast.texts.data(), ast.texts.size());
+    read(data, ast.chars.data(), ast.chars.size());
+    check_indices(ast);
+    return ast;
+}
+
+Flat_Ast flatten(const Ast_File& file) {
+    // Post-order walk with explicit stack. Indices of flattened children wait
+    // on value stack until their parent is flattened.
+    struct Frame {
+        const Ast_Node* node;
+        std::uint32_t   children;   // Count once expanded, NO_NODE before.
+    };
+    Flat_Ast                     ast;
+    Flattener                    flattener{ast};
+    std::vector<Frame>           frames{{&file, NO_NODE}};
+    std::vector<Node_Index>      values;
+    std::vector<const Ast_Node*> children;
+    while(!frames.empty()) {
+        const auto frame = frames.back();
+        frames.pop_back();
+        if(frame.node == nullptr) {
+            values.push_back(NO_NODE);
+            continue;
+        }
+        if(frame.children == NO_NODE) {
+            children.clear();
+            Child_Collector{children}.visit(*frame.node);
+            frames.push_back({frame.node,
+                    static_cast<std::uint32_t>(children.size())});
+            for(auto it = children.rbegin(); it != children.rend(); ++it) {
+                frames.push_back({*it, NO_NODE});
+            }
+            continue;
+        }
+        const auto first = values.size() - frame.children;
+        const auto index = flattener.flatten(*frame.node,
+                values.data() + first);
+        values.resize(first);
+        values.push_back(index);
+    }
+    ast.root = values.back();
+    return ast;
+}
+
+}
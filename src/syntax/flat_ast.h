@@ -0,0 +1,108 @@
+#ifndef TEZ_FLAT_AST_H
+#define TEZ_FLAT_AST_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "syntax/ast.h"
+
+namespace tez {
+
+using Node_Index = std::uint32_t;
+constexpr Node_Index NO_NODE = std::numeric_limits<Node_Index>::max();
+
+// Node of Flat_Ast. Meaning of data depends on type:
+//
+//   type                         flags     data[0]    data[1]    data[2]
+//   FILE, BLOCK,                 -         first      count      -
+//   ARRAY_INITIALIZER
+//   NAMESPACE                    -         name       body       -
+//   USING                        -         namespace  alias      -
+//   BOOLEAN                      value     -          -          -
+//   INTEGER, REAL_NUMBER         -         low bits   high bits  -
+//   STRING, IDENTIFIER           -         text       -          -
+//   UNARY_OPERATION              operator  operand    -          -
+//   BINARY_OPERATION             operator  left       right      -
+//   GROUPING_EXPRESSION, RETURN, -         expression -          -
+//   ADDRESS_OF, PTR_DEREFERENCE,
+//   NEW, FREE, POINTER
+//   CAST                         -         expression type       -
+//   FUNCTION_DECLARATION         -         name       first      count
+//   FUNCTION_CALL                -         name       first      count
+//   VARIABLE_DECLARATION         constant  name       type       initializer
+//   IF                           -         condition  block      else
+//   WHILE, DO_WHILE              -         condition  body       -
+//   FOR                          -         first      -          -
+//   STRUCT, UNION, ENUM          -         name       first      count
+//   ARRAY_ACCESS                 -         array      index      -
+//   MEMBER_ACCESS,               -         left       right      -
+//   SCOPE_RESOLUTION
+//   ARRAY                        -         type       size       -
+//   INLINE_ASM                   -         first      count      -
+//
+// Names and strings index texts, first and count select range of lists.
+// Lists hold node indices, except:
+//   - FUNCTION_DECLARATION: parent text (NO_NODE for free functions), return
+//     type, body, parameters.
+//   - FOR: init statement, condition, iteration expression, body (always 4).
+//   - INLINE_ASM: texts of operations.
+// Parameters, struct fields and union members are VARIABLE_DECLARATIONs
+// without initializer; enumerators have INTEGER initializer and no type.
+// Missing children (e.g. after syntax error) are NO_NODE.
+struct Flat_Node {
+    Ast_Node_Type type;
+    std::uint8_t  flags = 0;
+    std::uint16_t reserved = 0;
+    std::uint32_t data[3]{};
+};
+static_assert(sizeof(Flat_Node) == 16);
+
+struct Flat_Text {
+    std::uint32_t offset;   // In Flat_Ast::chars.
+    std::uint32_t length;
+};
+
+// Ast_File without pointers: nodes are in one array in post-order (children
+// before parents, root is last), variable length data is in side tables. It
+// doesn't refer to source buffer nor atom table, so it can be copied as bytes
+// and used in other process. Every node takes 16 bytes plus 4 for each list
+// entry; children are 4 byte indices instead of 8 byte pointers, and nodes
+// that follow each other in source follow each other in memory.
+struct Flat_Ast {
+    std::vector<Flat_Node>  nodes;
+    std::vector<Node_Index> lists;
+    std::vector<Flat_Text>  texts;
+    std::string             chars;
+    Node_Index              root = NO_NODE;     // FILE node.
+
+    const Flat_Node& operator[](Node_Index index) const { return nodes[index]; }
+    const Node_Index* list(std::uint32_t first) const {
+        return lists.data() + first;
+    }
+    std::string_view text(std::uint32_t index) const {
+        return {chars.data() + texts[index].offset, texts[index].length};
+    }
+
+    std::int64_t integer(const Flat_Node& node) const;
+    double real_number(const Flat_Node& node) const;
+
+    // Bytes used by all tables.
+    std::size_t memory() const;
+
+    // Tables copied one after another behind header with their sizes. Data
+    // is in native byte order. deserialize() throws std::invalid_argument if
+    // sizes don't match or any index points outside of its table, so
+    // corrupted data is rejected instead of being read out of bounds.
+    std::string serialize() const;
+    static Flat_Ast deserialize(std::string_view data);
+};
+
+// Convert pointer AST; works without recursion, like parser.
+Flat_Ast flatten(const Ast_File& file);
+
+}
+
+#endif //TEZ_FLAT_AST_H
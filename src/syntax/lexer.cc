@@ -1,41 +1,26 @@
 #include "lexer.h"
 
-#include <cctype>
+#include <cstring>
 
 #include <algorithm>
-#include <fstream>
 #include <iostream>
-#include <stdexcept>
+
+#include "syntax/char_scan.h"
+#include "syntax/source_buffer.h"
 
 namespace tez {
 
+static_assert(Source_Buffer::PADDING > SCAN_OVERREAD,
+        "Lexer relies on padding for vectorized scanning.");
+
 namespace {
 
-class File_Not_Found : public std::runtime_error {
-    using std::runtime_error::runtime_error;
+struct Keyword {
+    std::string_view spelling;
+    Token_Type       type;
 };
 
-// Get entire file content, including newlines.
-// NOTE: leaves empty line on the end.
-std::string read_file_content(const std::string& filename) {
-    std::ifstream file{filename};
-    if(!file.good()) {
-        throw File_Not_Found{"Failed to open file \"" + filename + "\".\n"};
-    }
-    std::string content;
-    while(!file.eof()) {
-        std::string line;
-        std::getline(file, line);
-        if(line != "\n") {
-            content += line + '\n';
-        }
-    }
-    return content;
-}
-
-}
-
-const std::map<std::string, Token_Type> Lexer::_keywords{
+constexpr Keyword KEYWORDS[]{
         {"namespace", Token_Type::KW_NAMESPACE},
         {"func",      Token_Type::KW_FUNC},
         {"return",    Token_Type::KW_RETURN},
@@ -50,7 +35,6 @@ const std::map<std::string, Token_Type> Lexer::_keywords{
         {"true",      Token_Type::KW_TRUE},
         {"false",     Token_Type::KW_FALSE},
         {"null",      Token_Type::KW_NULL},
-        {"struct",    Token_Type::KW_STRUCT},
         {"enum",      Token_Type::KW_ENUM},
         {"union",     Token_Type::KW_UNION},
         {"break",     Token_Type::KW_BREAK},
@@ -62,287 +46,345 @@ const std::map<std::string, Token_Type> Lexer::_keywords{
         {"asm",       Token_Type::KW_ASM},
 };
 
-const std::map<std::string, Token_Type> Lexer::_single_char_operators{
-        {"{", Token_Type::L_BRACE},
-        {"}", Token_Type::R_BRACE},
-        {"(", Token_Type::L_PAREN},
-        {")", Token_Type::R_PAREN},
-        {"[", Token_Type::L_BRACKET},
-        {"]", Token_Type::R_BRACKET},
-        {"+", Token_Type::PLUS},
-        {"-", Token_Type::MINUS},
-        {"*", Token_Type::ASTERISK},
-        {"/", Token_Type::SLASH},
-        {"&", Token_Type::AMPERSAND},
-        {"|", Token_Type::BITWISE_OR},
-        {"^", Token_Type::CARET},
-        {"%", Token_Type::MODULO},
-        {"!", Token_Type::BANG},
-        {"=", Token_Type::EQUALS},
-        {">", Token_Type::GREATER},
-        {"<", Token_Type::LESS},
-        {";", Token_Type::SEMICOLON},
-        {":", Token_Type::COLON},
-        {",", Token_Type::COMMA},
-        {".", Token_Type::DOT},
-};
+constexpr std::size_t KEYWORD_MIN_LENGTH = 2;
+constexpr std::size_t KEYWORD_MAX_LENGTH = 9;
+constexpr std::size_t KEYWORD_SLOTS = 64;
 
-const std::map<std::string, Token_Type> Lexer::_double_char_operators{
-        {"&&", Token_Type::LOGICAL_AND},
-        {"||", Token_Type::LOGICAL_OR},
-        {"<<", Token_Type::BITWISE_SHIFT_LEFT},
-        {">>", Token_Type::BITWISE_SHIFT_RIGHT},
-        {"+=", Token_Type::PLUS_EQUALS},
-        {"-=", Token_Type::MINUS_EQUALS},
-        {"*=", Token_Type::MULTIPLY_EQUALS},
-        {"/=", Token_Type::DIVIDE_EQUALS},
-        {"%=", Token_Type::MODULO_EQUALS},
-        {"!=", Token_Type::BANG_EQUALS},
-        {"&=", Token_Type::AND_EQUALS},
-        {"|=", Token_Type::OR_EQUALS},
-        {"^=", Token_Type::XOR_EQUALS},
-        {"==", Token_Type::EQUALS_EQUALS},
-        {">",  Token_Type::GREATER},
-        {">=", Token_Type::GREATER_EQUALS},
-        {"<",  Token_Type::LESS},
-        {"<=", Token_Type::LESS_EQUALS},
-        {"->", Token_Type::ARROW},
-        {"::", Token_Type::SCOPE_RESOLUTION},
-};
+// Perfect hash of keywords: first byte, last byte and length. Multipliers were
+// found by brute force; static_assert below checks there are no collisions, so
+// after adding keyword just search for new ones if it fires.
+constexpr std::size_t keyword_hash(std::string_view word) {
+    return (static_cast<unsigned char>(word.front()) * 3u
+            + static_cast<unsigned char>(word.back()) * 7u
+            + word.size()) % KEYWORD_SLOTS;
+}
 
-const std::map<std::string, Token_Type> Lexer::_triple_char_operators{
-        {"<<=", Token_Type::LEFT_SHIFT_EQUALS},
-        {">>=", Token_Type::RIGHT_SHIFT_EQUALS},
+// Empty slots have empty spelling, so they never match any identifier.
+struct Keyword_Table {
+    Keyword slots[KEYWORD_SLOTS]{};
 };
 
-Lexer::Lexer(const std::string& filename)
-        : _filename{filename} {
-    try {
-        _tez_source = read_file_content(filename);
-    } catch(const tez::File_Not_Found& e) {
-        std::cerr << "Error: " << e.what();
-        _errors_reported = true;
+constexpr Keyword_Table make_keyword_table() {
+    Keyword_Table table{};
+    for(const auto& keyword : KEYWORDS) {
+        table.slots[keyword_hash(keyword.spelling)] = keyword;
     }
+    return table;
 }
 
-Lexer::Lexer(const std::string& tez_source,
-        [[maybe_unused]] bool doesnt_matter) {
-    _tez_source = tez_source;
-}
+constexpr Keyword_Table KEYWORD_TABLE = make_keyword_table();
 
-bool Lexer::errors_reported() const {
-    return _errors_reported;
+constexpr bool keyword_hash_is_perfect() {
+    for(const auto& keyword : KEYWORDS) {
+        const auto& slot = KEYWORD_TABLE.slots[keyword_hash(keyword.spelling)];
+        if(slot.spelling != keyword.spelling
+                || keyword.spelling.size() < KEYWORD_MIN_LENGTH
+                || keyword.spelling.size() > KEYWORD_MAX_LENGTH) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void Lexer::report_error(const std::string& message) {
-    _errors_reported = true;
-    std::cerr << "<filename>:" << std::to_string(_lines_count) << ":"
-            << std::to_string(_current_char - _columns_count + 1) << ": "
-            << message << ".\n";
+static_assert(keyword_hash_is_perfect(), "Keyword hash has collisions.");
+
+// Returns keyword type or IDENTIFIER, if word isn't a keyword.
+Token_Type classify_word(std::string_view word) {
+    if(word.size() < KEYWORD_MIN_LENGTH || word.size() > KEYWORD_MAX_LENGTH) {
+        return Token_Type::IDENTIFIER;
+    }
+    const auto& slot = KEYWORD_TABLE.slots[keyword_hash(word)];
+    return slot.spelling == word ? slot.type : Token_Type::IDENTIFIER;
 }
 
-std::vector<Token> Lexer::tokenize() {
-    _tokens.clear();
-    // TODO: Make it cleaner, this is Jonathan Blow style function.
-    try {
-        while(_current_char < _tez_source.length()) {
-            char c = _tez_source.at(_current_char);
-            if(std::isspace(c)) {
-                handle_whitespace();
-                continue;
-            }
-            if(peek_string("//") || peek_string("/*")) {
-                handle_comment();
-                continue;
-            }
-            if(std::isspace(c)) {
-                handle_whitespace();
-                continue;
+// Longest match operator recognizer; a hand written DFA over at most 3 bytes.
+// Returns operator length, or 0 if text doesn't start with any operator.
+// Text has to be NUL terminated, NUL never matches any operator.
+std::size_t match_operator(const char* text, Token_Type& type) {
+    const auto at = [text](std::size_t i) {
+        return text[i];
+    };
+    // Operator 'c' or 'c='.
+    const auto with_equals = [&](Token_Type single, Token_Type equals) {
+        if(at(1) == '=') {
+            type = equals;
+            return std::size_t{2};
+        }
+        type = single;
+        return std::size_t{1};
+    };
+    switch(at(0)) {
+        case '{': type = Token_Type::L_BRACE;   return 1;
+        case '}': type = Token_Type::R_BRACE;   return 1;
+        case '(': type = Token_Type::L_PAREN;   return 1;
+        case ')': type = Token_Type::R_PAREN;   return 1;
+        case '[': type = Token_Type::L_BRACKET; return 1;
+        case ']': type = Token_Type::R_BRACKET; return 1;
+        case ';': type = Token_Type::SEMICOLON; return 1;
+        case ',': type = Token_Type::COMMA;     return 1;
+        case '.': type = Token_Type::DOT;       return 1;
+        case '+': return with_equals(Token_Type::PLUS, Token_Type::PLUS_EQUALS);
+        case '*': return with_equals(Token_Type::ASTERISK,
+                Token_Type::MULTIPLY_EQUALS);
+        case '/': return with_equals(Token_Type::SLASH,
+                Token_Type::DIVIDE_EQUALS);
+        case '%': return with_equals(Token_Type::MODULO,
+                Token_Type::MODULO_EQUALS);
+        case '^': return with_equals(Token_Type::CARET, Token_Type::XOR_EQUALS);
+        case '!': return with_equals(Token_Type::BANG, Token_Type::BANG_EQUALS);
+        case '=': return with_equals(Token_Type::EQUALS,
+                Token_Type::EQUALS_EQUALS);
+        case '-':
+            if(at(1) == '>') {
+                type = Token_Type::ARROW;
+                return 2;
             }
-            if(c == '"') {
-                push_string();
-                continue;
+            return with_equals(Token_Type::MINUS, Token_Type::MINUS_EQUALS);
+        case ':':
+            if(at(1) == ':') {
+                type = Token_Type::SCOPE_RESOLUTION;
+                return 2;
             }
-            if(c == '\'') {
-                push_character();
-                continue;
+            type = Token_Type::COLON;
+            return 1;
+        case '&':
+            if(at(1) == '&') {
+                type = Token_Type::LOGICAL_AND;
+                return 2;
             }
-            if(std::ispunct(c)) {
-                push_operator();
-                continue;
+            return with_equals(Token_Type::AMPERSAND, Token_Type::AND_EQUALS);
+        case '|':
+            if(at(1) == '|') {
+                type = Token_Type::LOGICAL_OR;
+                return 2;
             }
-            if(std::isdigit(c)) {
-                push_number(c);
-                continue;
+            return with_equals(Token_Type::BITWISE_OR, Token_Type::OR_EQUALS);
+        case '<':
+            if(at(1) == '<') {
+                if(at(2) == '=') {
+                    type = Token_Type::LEFT_SHIFT_EQUALS;
+                    return 3;
+                }
+                type = Token_Type::BITWISE_SHIFT_LEFT;
+                return 2;
             }
-            if(std::isalpha(c) || c == '_') {
-                push_identifier(c);
-                continue;
+            return with_equals(Token_Type::LESS, Token_Type::LESS_EQUALS);
+        case '>':
+            if(at(1) == '>') {
+                if(at(2) == '=') {
+                    type = Token_Type::RIGHT_SHIFT_EQUALS;
+                    return 3;
+                }
+                type = Token_Type::BITWISE_SHIFT_RIGHT;
+                return 2;
             }
-            report_error("Unexpected character '" + std::string{c} + "'");
-        }
-    } catch(const std::out_of_range& e) {
-        report_error("Unexpected end of file");
+            return with_equals(Token_Type::GREATER,
+                    Token_Type::GREATER_EQUALS);
+        default:
+            return 0;
     }
-    _tokens.shrink_to_fit();
-    return _tokens;
 }
 
-char Lexer::peek_char(std::size_t depth) const {
-    return _tez_source.at(_current_char + depth);
 }
 
-char Lexer::peek_string(const std::string&& to_peek) const {
-    const auto l = to_peek.length();
-    if(_current_char + l >= _tez_source.length()) {
-        return false;
+Lexer::Lexer(const File_Table& files, File_Id file, Diagnostics& diagnostics,
+        std::uint32_t offset)
+        : _files{files},
+          _file{file},
+          _diagnostics{diagnostics},
+          _source{files.source(file).data()},
+          _end{_source + files.source(file).length()},
+          _current{std::min(_source + offset, _end)} {
+}
+
+bool Lexer::errors_reported() const {
+    return _errors_reported;
+}
+
+void Lexer::report_error(Diagnostic_Id id, char c) {
+    _errors_reported = true;
+    if(!_diagnostics.report(Severity::ERROR, id, _file, offset(_current),
+            static_cast<unsigned char>(c))) {
+        _aborted = true;
     }
-    return _tez_source.substr(_current_char, l) == to_peek;
 }
 
-void Lexer::push_token(Token_Type type, const std::string& value) {
-    _tokens.push_back({type, value, _filename, _lines_count,
-            _current_char - _columns_count + 1});
+// Source is terminated with NUL, so there are no bounds checks, except when
+// NUL is found: it's either end of file or stray character.
+Token Lexer::next() {
+    if(_aborted) {      // Error limit was reached, pretend file ended.
+        push_token(Token_Type::END_OF_FILE, _end, 0);
+        return _token;
+    }
+    _has_token = false;
+    while(!_has_token) {
+        const char c = *_current;
+        if(is_whitespace(c)) {
+            handle_whitespace();
+        } else if(c == '/' && (_current[1] == '/' || _current[1] == '*')) {
+            handle_comment();
+        } else if(c == '"') {
+            push_string();
+        } else if(c == '\'') {
+            push_character();
+        } else if(is_punct(c)) {
+            push_operator();
+        } else if(is_digit(c)) {
+            push_number();
+        } else if(is_identifier_start(c)) {
+            push_identifier();
+        } else if(_current >= _end) {
+            push_token(Token_Type::END_OF_FILE, _end, 0);
+        } else {
+            report_error(Diagnostic_Id::UNEXPECTED_CHARACTER, c);
+            ++_current;
+        }
+    }
+    return _token;
 }
 
-void Lexer::push_token(Token_Type type, const std::string& value,
-        unsigned int col) {
-    _tokens.push_back({type, value, _filename, _lines_count, col + 1});
+std::vector<Token> Lexer::tokenize() {
+    std::vector<Token> tokens;
+    // Rough estimate, to avoid most of reallocations on big files.
+    tokens.reserve((_end - _source) / 4);
+    for(auto token = next(); token.type != Token_Type::END_OF_FILE;
+            token = next()) {
+        tokens.push_back(token);
+    }
+    tokens.shrink_to_fit();
+    return tokens;
+}
+
+void Lexer::push_token(Token_Type type, const char* begin, std::size_t length) {
+    _token = {type, _file, offset(begin), static_cast<std::uint32_t>(length),
+            Atom{}};
+    _has_token = true;
 }
 
 void Lexer::handle_whitespace() {
-    char c = _tez_source.at(_current_char);
-    if(c == '\n') {
-        ++_lines_count;
-        _columns_count = _current_char;
+    // Single separating character is the most common case, vectors don't pay
+    // off for it.
+    if(!is_whitespace(_current[1])) {
+        ++_current;
+        return;
     }
-    ++_current_char;
+    _current = skip_whitespace(_current);
 }
 
-// TODO: Nested multiline comments.
 void Lexer::handle_comment() {
-    if(peek_string("//")) {
-        while(_tez_source.at(_current_char) != '\n') {
-            ++_current_char;
-        }
+    const char* p = _current + 2;
+    if(_current[1] == '/') {
+        // Newline itself is left for handle_whitespace().
+        auto newline = static_cast<const char*>(
+                std::memchr(p, '\n', _end - p));
+        _current = newline != nullptr ? newline : _end;
         return;
     }
-    // When "/*".
-    while(!peek_string("*/")) {
-        if(_tez_source.at(_current_char) == '\n') {
-            ++_lines_count;
-            _columns_count = _current_char;
+    // When "/*". Comments can be nested, so only "/*" and "*/" matter.
+    std::size_t depth = 1;
+    while(depth > 0) {
+        p = find_either(p, _end, '*', '/');
+        if(p == _end) {
+            _current = _end;
+            report_error(Diagnostic_Id::UNEXPECTED_END_OF_FILE);
+            return;
+        }
+        if(p[0] == '*' && p[1] == '/') {
+            --depth;
+            p += 2;
+        } else if(p[0] == '/' && p[1] == '*') {
+            ++depth;
+            p += 2;
+        } else {
+            ++p;
         }
-        ++_current_char;
     }
-    _current_char += 2;
+    _current = p;
 }
 
 void Lexer::push_operator() {
-    // Because all operators are made from 1 or 2 characters.
-    std::string three_chars{_tez_source.substr(_current_char, 3)};
-    if(auto res = _triple_char_operators.find(three_chars);
-            res != _triple_char_operators.end()) {
-        push_token(res->second, "");
-        _current_char += 3;
+    Token_Type type;
+    // Sentinel stops matching at the end of file.
+    const auto length = match_operator(_current, type);
+    if(length == 0) {
+        report_error(Diagnostic_Id::UNKNOWN_OPERATOR, *_current);
+        ++_current;
         return;
     }
-    std::string two_chars{_tez_source.substr(_current_char, 2)};
-    if(auto res = _double_char_operators.find(two_chars);
-            res != _double_char_operators.end()) {
-        push_token(res->second, "");
-        _current_char += 2;
-        return;
-    }
-    std::string op{_tez_source.at(_current_char)};
-    if(auto res = _single_char_operators.find(op);
-            res != _single_char_operators.end()) {
-        push_token(res->second, "");
-        ++_current_char;
-        return;
-    }
-    report_error("Unknown operator '"
-            + std::string{_tez_source.at(_current_char)} + "'");
-    ++_current_char;
+    push_token(type, _current, length);
+    _current += length;
 }
 
-void Lexer::push_number(char c) {
-    std::size_t beginning = _current_char;
-    std::string number;
+void Lexer::push_number() {
+    const char* beginning = _current;
     bool is_real = false;   // False means integer value.
-    while(std::isdigit(c) || c == '.') {
-        if(c == '.') {
+    for(; is_digit(*_current) || *_current == '.'; ++_current) {
+        if(*_current == '.') {
             if(is_real) {   // Error if dot was used before.
-                report_error("Too many decimal points in number.");
+                report_error(Diagnostic_Id::TOO_MANY_DECIMAL_POINTS);
             }
             is_real = true;
         }
-        number += c;
-        try {
-            c = _tez_source.at(++_current_char);
-        } catch(const std::out_of_range& e) {
-            break;
-        }
-    }
-    if(is_real) {
-        push_token(Token_Type::REAL_NUMBER, number, beginning - _columns_count);
-    } else {
-        push_token(Token_Type::INTEGER, number, beginning - _columns_count);
     }
+    push_token(is_real ? Token_Type::REAL_NUMBER : Token_Type::INTEGER,
+            beginning, _current - beginning);
 }
 
-void Lexer::push_identifier(char c) {
-    std::size_t beginning = _current_char;
-    std::string word;
-    while(std::isalpha(c) || std::isdigit(c) || c == '_') {
-        word += c;
-        try {
-            c = _tez_source.at(++_current_char);
-        } catch(const std::out_of_range& e) {
-            break;
-        }
-    }
-    auto keyword = _keywords.find(word);
-    if(keyword != _keywords.end()) {
-        push_token(keyword->second, "");
-    } else {
-        push_token(Token_Type::IDENTIFIER, word, beginning - _columns_count);
+void Lexer::push_identifier() {
+    const char* beginning = _current;
+    _current = skip_identifier(_current);
+    const std::string_view word{beginning,
+            static_cast<std::size_t>(_current - beginning)};
+    const auto type = classify_word(word);
+    push_token(type, beginning, word.length());
+    if(type == Token_Type::IDENTIFIER) {
+        _token.atom = _atoms.intern(word);
     }
 }
 
 void Lexer::push_string() {
-    std::size_t beginning = _current_char;
-    char c = _tez_source.at(++_current_char);
-    std::string s;
-    bool escape_char = false;
-    while(c != '"' || escape_char) {
-        escape_char = false;
-        s.push_back(c);
-        if(c == '\\') {
-            escape_char = true;
+    const char* beginning = _current + 1;   // Skip '"'.
+    const char* p = beginning;
+    for(;;) {
+        p = find_either(p, _end, '"', '\\');
+        if(p == _end) {
+            _current = _end;
+            report_error(Diagnostic_Id::UNEXPECTED_END_OF_FILE);
+            return;
+        }
+        if(*p == '"') {
+            break;
         }
-        c = _tez_source.at(++_current_char);
+        p = std::min(p + 2, _end);  // Skip escaped character.
     }
-    ++_current_char;
-    push_token(Token_Type::STRING, s, beginning - _columns_count);
+    push_token(Token_Type::STRING, beginning, p - beginning);
+    _current = p + 1;
 }
 
 void Lexer::push_character() {
-    std::size_t beginning = _current_char - _columns_count;
-    std::string character = {_tez_source.at(++_current_char)};
-    if(character == "\\") {
-        character += _tez_source.at(++_current_char);
+    const char* beginning = _current + 1;   // Skip '\''.
+    const char* p = beginning;
+    if(*p == '\\') {
+        ++p;
     }
-    char c = _tez_source.at(_current_char);
-    if(c = _tez_source.at(++_current_char); c != '\'') {
-        report_error("Expected ''', got '" + std::string{c} + "'");
-        while(c != '\'') {
-            c = ++_current_char;
+    if(p >= _end) {
+        _current = _end;
+        report_error(Diagnostic_Id::UNEXPECTED_END_OF_FILE);
+        return;
+    }
+    const std::size_t length = p - beginning + 1;
+    _current = p + 1;
+    if(*_current != '\'') {
+        report_error(Diagnostic_Id::EXPECTED_QUOTE, *_current);
+        auto quote = static_cast<const char*>(
+                std::memchr(_current, '\'', _end - _current));
+        _current = quote != nullptr ? quote : _end;
+        if(_current == _end) {
+            return;
         }
     }
-    ++_current_char;
-    push_token(Token_Type::CHARACTER, {character}, beginning);
+    ++_current;
+    push_token(Token_Type::CHARACTER, beginning, length);
 }
 
 }
-
@@ -2,9 +2,11 @@
 #define TEZ_LEXER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 
+#include "syntax/diagnostics.h"
+#include "syntax/file_table.h"
 #include "syntax/token.h"
 
 namespace tez {
@@ -13,52 +15,51 @@ using File_Tokens = std::vector<Token>;
 
 class Lexer {
 public:
-    Lexer(const std::string& filename);
-    
-    // This constructor is only used for unit tests.
-    // Second parameter is workaround for ambigious call (1st constructor
-    // also takes only 1 std::string parameter).
-    Lexer(const std::string& tez_source, bool doesnt_matter);
-
-    // Create tokens from given source code.
+    // Source is taken from file table, which must outlive produced tokens.
+    // Errors are reported to diagnostics; when their limit is reached, lexer
+    // stops as if the file ended. Lexing may start in the middle of file, at
+    // offset outside of any comment, string or token.
+    Lexer(const File_Table& files, File_Id file, Diagnostics& diagnostics,
+            std::uint32_t offset = 0);
+
+    // Lex next token. After the last one, END_OF_FILE is returned forever.
+    Token next();
+
+    // Create tokens from given source code (without END_OF_FILE).
     std::vector<Token> tokenize();
 
     bool errors_reported() const;
 
 private:
-    void report_error(const std::string& message);
-    
-    char peek_char(std::size_t depth = 1) const;
-    char peek_string(const std::string&& to_peek) const;
+    void report_error(Diagnostic_Id id, char c = '\0');
+
+    std::uint32_t offset(const char* position) const {
+        return static_cast<std::uint32_t>(position - _source);
+    }
 
-    void push_token(Token_Type type, const std::string& value = "");
-    void push_token(Token_Type type, const std::string& value,
-            unsigned int col);
+    void push_token(Token_Type type, const char* begin, std::size_t length);
 
     void handle_whitespace();
     void handle_comment();
 
     void push_operator();
-    void push_number(char c);
-    void push_identifier(char c);
+    void push_number();
+    void push_identifier();
     void push_string();
     void push_character();
-    
-    const std::string  _working_path;
-    const std::string  _filename;
-    std::string        _tez_source;
-    File_Tokens        _tokens;
-
-    unsigned int _current_char = 0;
-    unsigned int _lines_count = 1;
-    unsigned int _columns_count = 0;
-    
-    bool _errors_reported = false;
 
-    static const std::map<std::string, Token_Type> _keywords;
-    static const std::map<std::string, Token_Type> _single_char_operators;
-    static const std::map<std::string, Token_Type> _double_char_operators;
-    static const std::map<std::string, Token_Type> _triple_char_operators;
+    const File_Table&  _files;
+    const File_Id      _file;
+    Diagnostics&       _diagnostics;
+    const char*        _source;        // File's source buffer.
+    const char*        _end;           // NUL sentinel after last character.
+    const char*        _current;       // Next character to lex.
+    Token              _token{};       // Result of next().
+    Atom_Cache         _atoms{Atom_Table::global()};
+    bool               _has_token = false;
+
+    bool _errors_reported = false;
+    bool _aborted = false;
 };
 
 }
@@ -1,60 +1,252 @@
 #include "parser.h"
 
-#include <iostream>
+#include <algorithm>
+#include <array>
+
+#include "syntax/ast_visitor.h"
+#include "syntax/lexer.h"
 
 namespace tez {
 
-Parser::Parser(const std::vector<Token>& tokens)
-        : _tokens{tokens} {
+namespace {
+
+constexpr std::size_t TOKEN_TYPES_COUNT
+        = static_cast<std::size_t>(Token_Type::END_OF_FILE) + 1;
+
+// Binding power of every infix and postfix operator, NONE for tokens that end
+// expression. Precedence is documented in doc/operators.md.
+constexpr auto INFIX_POWERS = [] {
+    std::array<std::uint8_t, TOKEN_TYPES_COUNT> powers{};
+    auto set = [&powers](std::initializer_list<Token_Type> types, int power) {
+        for(auto type : types) {
+            powers[static_cast<std::size_t>(type)] = power;
+        }
+    };
+    using T = Token_Type;
+    set({T::EQUALS, T::PLUS_EQUALS, T::MINUS_EQUALS, T::MULTIPLY_EQUALS,
+            T::DIVIDE_EQUALS, T::MODULO_EQUALS, T::AND_EQUALS, T::OR_EQUALS,
+            T::XOR_EQUALS, T::LEFT_SHIFT_EQUALS, T::RIGHT_SHIFT_EQUALS},
+            Parser::ASSIGNMENT);
+    set({T::LOGICAL_OR}, Parser::LOGICAL_OR);
+    set({T::LOGICAL_AND}, Parser::LOGICAL_AND);
+    set({T::BITWISE_OR}, Parser::BITWISE_OR);
+    set({T::CARET}, Parser::BITWISE_XOR);
+    set({T::AMPERSAND}, Parser::BITWISE_AND);
+    set({T::EQUALS_EQUALS, T::BANG_EQUALS}, Parser::EQUALITY);
+    set({T::GREATER, T::GREATER_EQUALS, T::LESS, T::LESS_EQUALS},
+            Parser::COMPARISON);
+    set({T::BITWISE_SHIFT_LEFT, T::BITWISE_SHIFT_RIGHT}, Parser::SHIFT);
+    set({T::PLUS, T::MINUS}, Parser::ADDITIVE);
+    set({T::ASTERISK, T::SLASH, T::MODULO}, Parser::MULTIPLICATIVE);
+    set({T::KW_AS}, Parser::CAST);
+    set({T::L_PAREN, T::L_BRACKET, T::DOT, T::ARROW}, Parser::POSTFIX);
+    set({T::SCOPE_RESOLUTION}, Parser::SCOPE);
+    return powers;
+}();
+
+// Only for tokens with binding power between ASSIGNMENT and MULTIPLICATIVE.
+Operator binary_operator(Token_Type type) {
+    switch(type) {
+    case Token_Type::EQUALS:              return Operator::ASSIGN;
+    case Token_Type::PLUS_EQUALS:         return Operator::ADD_ASSIGN;
+    case Token_Type::MINUS_EQUALS:        return Operator::SUBTRACT_ASSIGN;
+    case Token_Type::MULTIPLY_EQUALS:     return Operator::MULTIPLY_ASSIGN;
+    case Token_Type::DIVIDE_EQUALS:       return Operator::DIVIDE_ASSIGN;
+    case Token_Type::MODULO_EQUALS:       return Operator::MODULO_ASSIGN;
+    case Token_Type::AND_EQUALS:          return Operator::AND_ASSIGN;
+    case Token_Type::OR_EQUALS:           return Operator::OR_ASSIGN;
+    case Token_Type::XOR_EQUALS:          return Operator::XOR_ASSIGN;
+    case Token_Type::LEFT_SHIFT_EQUALS:   return Operator::SHIFT_LEFT_ASSIGN;
+    case Token_Type::RIGHT_SHIFT_EQUALS:  return Operator::SHIFT_RIGHT_ASSIGN;
+    case Token_Type::LOGICAL_OR:          return Operator::LOGICAL_OR;
+    case Token_Type::LOGICAL_AND:         return Operator::LOGICAL_AND;
+    case Token_Type::BITWISE_OR:          return Operator::BITWISE_OR;
+    case Token_Type::CARET:               return Operator::BITWISE_XOR;
+    case Token_Type::AMPERSAND:           return Operator::BITWISE_AND;
+    case Token_Type::EQUALS_EQUALS:       return Operator::EQUAL;
+    case Token_Type::BANG_EQUALS:         return Operator::NOT_EQUAL;
+    case Token_Type::LESS:                return Operator::LESS;
+    case Token_Type::LESS_EQUALS:         return Operator::LESS_EQUAL;
+    case Token_Type::GREATER:             return Operator::GREATER;
+    case Token_Type::GREATER_EQUALS:      return Operator::GREATER_EQUAL;
+    case Token_Type::BITWISE_SHIFT_LEFT:  return Operator::SHIFT_LEFT;
+    case Token_Type::BITWISE_SHIFT_RIGHT: return Operator::SHIFT_RIGHT;
+    case Token_Type::PLUS:                return Operator::ADD;
+    case Token_Type::MINUS:               return Operator::SUBTRACT;
+    case Token_Type::ASTERISK:            return Operator::MULTIPLY;
+    case Token_Type::SLASH:               return Operator::DIVIDE;
+    default:                              return Operator::MODULO;
+    }
+}
+
+}
+
+Parser::Parser(Lexer& lexer, const File_Table& files,
+        Diagnostics& diagnostics)
+        : _stream{lexer},
+          _files{files},
+          _diagnostics{diagnostics} {
+}
+
+Parser::Parser(const std::vector<Token>& tokens, const File_Table& files,
+        Diagnostics& diagnostics)
+        : _stream{tokens},
+          _files{files},
+          _diagnostics{diagnostics} {
+}
+
+Parser::Parser(const Token_Buffer& tokens, const File_Table& files,
+        Diagnostics& diagnostics)
+        : _stream{tokens},
+          _files{files},
+          _diagnostics{diagnostics} {
 }
 
 Ast_File Parser::parse() {
     Ast_File file;
-    _current = 0;
-    while(_current < _tokens.size()) {
+    while(!_stream.at_end() && !_diagnostics.limit_reached()) {
+        const auto begin = statement_begin();
         file.statements.push_back(statement());
+        file.ranges.push_back({begin, statement_end()});
     }
+    file.arena = std::move(_arena);
     return file;
 }
 
+bool Parser::reparse(Ast_File& file, File_Id id, const Text_Edit& edit,
+        const File_Table& files, Diagnostics& diagnostics) {
+    const auto& old_ranges = file.ranges;
+    const auto edit_end = edit.offset
+            + static_cast<std::uint32_t>(edit.inserted.size());
+    // Shift of everything after the edit, modulo 2^32.
+    const auto delta = static_cast<std::uint32_t>(edit.inserted.size())
+            - edit.removed;
+
+    // First statement reaching the edit; touching counts, because edit may
+    // extend its last token. Range of each statement ends where the next one
+    // begins, so lexing starts at a token and never inside a comment.
+    const auto first = static_cast<std::size_t>(std::lower_bound(
+            old_ranges.begin(), old_ranges.end(), edit.offset,
+            [](const Source_Range& range, std::uint32_t offset) {
+                return range.end < offset;
+            }) - old_ranges.begin());
+    const auto start = first == 0 ? 0 : first < old_ranges.size()
+            ? old_ranges[first].begin : old_ranges.back().end;
+
+    std::vector<Ast_Node_Ptr> statements;     // Replacing [first, resume).
+    std::vector<Source_Range> ranges;
+    auto resume = old_ranges.size();
+    bool in_sync = false;
+
+    Lexer  lexer{files, id, diagnostics, start};
+    Parser parser{lexer, files, diagnostics};
+    parser._arena = std::move(file.arena);
+    while(!parser._stream.at_end() && !diagnostics.limit_reached()) {
+        const auto begin = parser.statement_begin();
+        // Past edited text, old statement starting at the same place is
+        // parsed the same way, so it and all after it are reused.
+        if(begin >= edit_end) {
+            const auto old_begin = begin - delta;
+            const auto old = std::lower_bound(old_ranges.begin() + first,
+                    old_ranges.end(), old_begin,
+                    [](const Source_Range& range, std::uint32_t offset) {
+                        return range.begin < offset;
+                    });
+            if(old != old_ranges.end() && old->begin == old_begin) {
+                resume = old - old_ranges.begin();
+                in_sync = true;
+                break;
+            }
+        }
+        statements.push_back(parser.statement());
+        ranges.push_back({begin, parser.statement_end()});
+    }
+    file.arena = std::move(parser._arena);
+    // Statements after the stop weren't parsed, nor can old ones be kept.
+    if(!in_sync && diagnostics.limit_reached()) {
+        return false;
+    }
+
+    file.statements.erase(file.statements.begin() + first,
+            file.statements.begin() + resume);
+    file.statements.insert(file.statements.begin() + first,
+            statements.begin(), statements.end());
+    file.ranges.erase(file.ranges.begin() + first,
+            file.ranges.begin() + resume);
+    file.ranges.insert(file.ranges.begin() + first,
+            ranges.begin(), ranges.end());
+    for(auto i = first + ranges.size(); i < file.ranges.size(); ++i) {
+        file.ranges[i].begin += delta;
+        file.ranges[i].end += delta;
+    }
+    return true;
+}
+
 bool Parser::errors_reported() const {
     return _errors_reported;
 }
 
-Token Parser::next_token() {
-    if(_current < _tokens.size()) {
-        return _tokens.at(_current++);
-    }
-    return _tokens.at(_current);
+const Token& Parser::next_token() {
+    const auto& token = _stream.peek(0);
+    _stream.advance();
+    return token;
 }
 
-Token Parser::next_token(Token_Type type) {
-    if(_current >= _tokens.size()) {    // All tokens were consumed.
-        return _tokens.at(_current);
+const Token& Parser::next_token(Token_Type type) {
+    if(_stream.at_end()) {      // All tokens were consumed.
+        return _stream.peek(0);
     }
-    auto token = _tokens.at(_current++);
+    const auto& token = next_token();
     if(token.type != type) {
-        report_error("Expected " + to_string(type) + ", got "
-                + to_string(token.type));
+        _mismatched = token;
+        report_error(Diagnostic_Id::EXPECTED_TOKEN,
+                static_cast<std::uint32_t>(type),
+                static_cast<std::uint32_t>(token.type));
+        return _mismatched;
     }
     return token;
 }
 
-Token Parser::peek_token(size_t depth) const {
-    if(_current + depth >= _tokens.size()) {
-        return _tokens.back();  // Return EOF.
+const Token& Parser::peek_token(int depth) const {
+    return _stream.peek(depth);
+}
+
+std::string Parser::value(const Token& token) const {
+    return std::string{_files.lexeme(token)};
+}
+
+std::uint32_t Parser::statement_begin() const {
+    const auto& token = peek_token(0);
+    // Lexeme of string and character excludes quotes.
+    const bool quoted = token.type == Token_Type::STRING
+            || token.type == Token_Type::CHARACTER;
+    return token.offset - (quoted ? 1 : 0);
+}
+
+std::uint32_t Parser::statement_end() const {
+    if(_stream.at_end()) {
+        // Trailing whitespace and comments belong to the last statement.
+        return static_cast<std::uint32_t>(
+                _files.source(peek_token(-1).file).size());
     }
-    return _tokens.at(_current + depth);
+    return statement_begin();
 }
 
-void Parser::report_error(const std::string& message) {
+void Parser::report_error(Diagnostic_Id id, std::uint32_t arg0,
+        std::uint32_t arg1) {
     _errors_reported = true;
-    auto token = peek_token(-1);
-    std::cerr << token.filename << ':' << token.line << ':' << token.column
-            << ": " << message << ".\n";
+    // Before first token, stream returns END_OF_FILE at offset 0.
+    const auto& token = peek_token(-1);
+    if(!_diagnostics.report(Severity::ERROR, id, token.file, token.offset,
+            arg0, arg1)) {
+        return;     // Error limit reached, parsing is being abandoned.
+    }
     while(!match_token({Token_Type::SEMICOLON, Token_Type::L_BRACE,
             Token_Type::R_BRACE, Token_Type::L_PAREN, Token_Type::R_PAREN,
             Token_Type::COMMA})) {
+        if(_stream.at_end()) {
+            return;
+        }
         next_token();
     }
 }
@@ -106,12 +298,12 @@ Ast_Node_Ptr Parser::statement() {
         return node;
     }
     if(match_token({Token_Type::KW_BREAK})) {
-        auto node = std::make_unique<Ast_Break>();
+        auto node = _arena->make<Ast_Break>();
         next_token(Token_Type::SEMICOLON);
         return node;
     }
     if(match_token({Token_Type::KW_CONTINUE})) {
-        auto node = std::make_unique<Ast_Continue>();
+        auto node = _arena->make<Ast_Continue>();
         next_token(Token_Type::SEMICOLON);
         return node;
     }
@@ -121,14 +313,14 @@ Ast_Node_Ptr Parser::statement() {
         return node;
     }
     if(match_token({Token_Type::KW_RETURN})) {
-        auto node = std::make_unique<Ast_Return>();
-        dynamic_cast<Ast_Return&>(*node).expr = expression();
+        auto node = _arena->make<Ast_Return>();
+        node->expr = expression();
         next_token(Token_Type::SEMICOLON);
         return node;
     }
     if(match_token({Token_Type::KW_FREE})) {
-        auto node = std::make_unique<Ast_Free>();
-        dynamic_cast<Ast_Free&>(*node).what = postfix_unary();
+        auto node = _arena->make<Ast_Free>();
+        node->what = expression(POSTFIX);
         next_token(Token_Type::SEMICOLON);
         return node;
     }
@@ -139,23 +331,23 @@ Ast_Node_Ptr Parser::statement() {
 }
 
 Ast_Node_Ptr Parser::namespace_declaration() {
-    auto ns = std::make_unique<Ast_Namespace>();
-    ns->name = next_token(Token_Type::IDENTIFIER).value;
+    auto ns = _arena->make<Ast_Namespace>();
+    ns->name = next_token(Token_Type::IDENTIFIER).atom;
     auto& current_ns = ns;
     while(match_token({Token_Type::SCOPE_RESOLUTION})) {
-        auto nested_ns = std::make_unique<Ast_Namespace>();
-        nested_ns->name = next_token(Token_Type::IDENTIFIER).value;
-        current_ns->body.statements.push_back(std::move(nested_ns));
+        auto nested_ns = _arena->make<Ast_Namespace>();
+        nested_ns->name = next_token(Token_Type::IDENTIFIER).atom;
+        current_ns->body.statements.push_back(*_arena, nested_ns);
     }
     current_ns->body = block();
     return ns;
 }
 
 Ast_Node_Ptr Parser::using_declaration() {
-    auto using_decl = std::make_unique<Ast_Using>();
-    using_decl->nspace = next_token(Token_Type::IDENTIFIER).value;
+    auto using_decl = _arena->make<Ast_Using>();
+    using_decl->nspace = next_token(Token_Type::IDENTIFIER).atom;
     if(match_token({Token_Type::KW_AS})) {
-        using_decl->alias = next_token(Token_Type::IDENTIFIER).value;
+        using_decl->alias = next_token(Token_Type::IDENTIFIER).atom;
     }
     return using_decl;
 }
@@ -163,37 +355,41 @@ Ast_Node_Ptr Parser::using_declaration() {
 Ast_Block Parser::block() {
     Ast_Block _block;
     next_token(Token_Type::L_BRACE);
-    try {
-        while(!match_token({Token_Type::R_BRACE})) {
-            _block.statements.push_back(statement());
+    while(!match_token({Token_Type::R_BRACE})) {
+        if(_stream.at_end()) {
+            report_error(Diagnostic_Id::MISSING_CLOSING_BRACE);
+            break;
         }
-    } catch(const std::out_of_range& e) {
-        report_error("Missing closing '}'");
+        if(_diagnostics.limit_reached()) {
+            break;
+        }
+        _block.statements.push_back(*_arena, statement());
     }
     return _block;
 }
 
 Ast_Node_Ptr Parser::function_declaration() {
-    auto func = std::make_unique<Ast_Func_Decl>();
-    const auto name = next_token(Token_Type::IDENTIFIER).value;
+    auto func = _arena->make<Ast_Func_Decl>();
+    const auto name = next_token(Token_Type::IDENTIFIER).atom;
     if(match_token({Token_Type::SCOPE_RESOLUTION})) {
         func->parent = name;
-        func->name = next_token(Token_Type::IDENTIFIER).value;
+        func->name = next_token(Token_Type::IDENTIFIER).atom;
     } else {
         func->name = name;
     }
     next_token(Token_Type::L_PAREN);
     if(!check_token(Token_Type::R_PAREN)) {
         do {
-            func->params.push_back(function_param());
+            func->params.push_back(*_arena, function_param());
         } while(match_token({Token_Type::COMMA}));
     }
     next_token(Token_Type::R_PAREN);
     if(match_token({Token_Type::ARROW})) {
         func->return_type = type();
     } else {
-        func->return_type = std::make_unique<Ast_Identifier>();
-        dynamic_cast<Ast_Identifier&>(*func->return_type).name = "void";
+        auto void_type = _arena->make<Ast_Identifier>();
+        void_type->name = intern("void");
+        func->return_type = void_type;
     }
     func->body = block();
     return func;
@@ -201,7 +397,7 @@ Ast_Node_Ptr Parser::function_declaration() {
 
 Ast_Func_Decl::Param Parser::function_param() {
     Ast_Func_Decl::Param param;
-    param.name = next_token(Token_Type::IDENTIFIER).value;
+    param.name = next_token(Token_Type::IDENTIFIER).atom;
     next_token(Token_Type::COLON);
     if(match_token({Token_Type::KW_VAR})) {
         param.constant = false;
@@ -210,12 +406,12 @@ Ast_Func_Decl::Param Parser::function_param() {
     return param;
 }
 
-Ast_Node_Ptr Parser::function_call(const std::string& name) {
-    auto call = std::make_unique<Ast_Func_Call>();
+Ast_Node_Ptr Parser::function_call(Atom name) {
+    auto call = _arena->make<Ast_Func_Call>();
     call->name = name;
     if(!match_token({Token_Type::R_PAREN})) {
         do {
-            call->args.push_back(expression());
+            call->args.push_back(*_arena, expression());
         } while(match_token({Token_Type::COMMA}));
         next_token(Token_Type::R_PAREN);
     }
@@ -223,9 +419,9 @@ Ast_Node_Ptr Parser::function_call(const std::string& name) {
 }
 
 Ast_Node_Ptr Parser::variable_declaration(bool constant) {
-    auto decl = std::make_unique<Ast_Var_Decl>();
+    auto decl = _arena->make<Ast_Var_Decl>();
     decl->constant = constant;
-    decl->name = next_token(Token_Type::IDENTIFIER).value;
+    decl->name = next_token(Token_Type::IDENTIFIER).atom;
     next_token(Token_Type::COLON);
     decl->type = type();
     if(match_token({Token_Type::EQUALS})) {
@@ -235,33 +431,40 @@ Ast_Node_Ptr Parser::variable_declaration(bool constant) {
 }
 
 Ast_Node_Ptr Parser::structure() {
-    auto struct_decl = std::make_unique<Ast_Struct>();
-    struct_decl->name = next_token(Token_Type::IDENTIFIER).value;
+    auto struct_decl = _arena->make<Ast_Struct>();
+    struct_decl->name = next_token(Token_Type::IDENTIFIER).atom;
     next_token(Token_Type::L_BRACE);
     while(!match_token({Token_Type::R_BRACE})) {
+        if(_stream.at_end()) {
+            report_error(Diagnostic_Id::MISSING_CLOSING_BRACE);
+            break;
+        }
+        if(_diagnostics.limit_reached()) {
+            break;
+        }
         Ast_Struct::Field field;
-        field.name = next_token(Token_Type::IDENTIFIER).value;
+        field.name = next_token(Token_Type::IDENTIFIER).atom;
         next_token(Token_Type::COLON);
         field.type = type();
         next_token(Token_Type::SEMICOLON);
-        struct_decl->fields.push_back(std::move(field));
+        struct_decl->fields.push_back(*_arena, field);
     }
     return struct_decl;
 }
 
 Ast_Node_Ptr Parser::enumeration() {
-    auto enumeration = std::make_unique<Ast_Enum>();
+    auto enumeration = _arena->make<Ast_Enum>();
     std::size_t counter = 0;
-    enumeration->name = next_token(Token_Type::IDENTIFIER).value;
+    enumeration->name = next_token(Token_Type::IDENTIFIER).atom;
     next_token(Token_Type::L_BRACE);
     do {
         Ast_Enum::Enumerator enumerator;
-        enumerator.name = next_token(Token_Type::IDENTIFIER).value;
+        enumerator.name = next_token(Token_Type::IDENTIFIER).atom;
         if(match_token({Token_Type::EQUALS})) {
-            counter = std::stoi(next_token(Token_Type::INTEGER).value);
+            counter = std::stoi(value(next_token(Token_Type::INTEGER)));
         }
         enumerator.value = counter;
-        enumeration->enumerations.push_back(enumerator);
+        enumeration->enumerations.push_back(*_arena, enumerator);
         ++counter;
     } while(match_token({Token_Type::COMMA}));
     next_token(Token_Type::R_BRACE);
@@ -269,46 +472,56 @@ Ast_Node_Ptr Parser::enumeration() {
 }
 
 Ast_Node_Ptr Parser::union_declaration() {
-    auto union_decl = std::make_unique<Ast_Union_Decl>();
-    union_decl->name = next_token(Token_Type::IDENTIFIER).value;
+    auto union_decl = _arena->make<Ast_Union_Decl>();
+    union_decl->name = next_token(Token_Type::IDENTIFIER).atom;
     next_token(Token_Type::L_BRACE);
     while(!match_token({Token_Type::R_BRACE})) {
+        if(_stream.at_end()) {
+            report_error(Diagnostic_Id::MISSING_CLOSING_BRACE);
+            break;
+        }
+        if(_diagnostics.limit_reached()) {
+            break;
+        }
         Ast_Union_Decl::Member member;
-        member.name = next_token(Token_Type::IDENTIFIER).value;
+        member.name = next_token(Token_Type::IDENTIFIER).atom;
         next_token(Token_Type::COLON);
         member.type = type();
         next_token(Token_Type::SEMICOLON);
-        union_decl->members.push_back(std::move(member));
+        union_decl->members.push_back(*_arena, member);
     }
     return union_decl;
 }
 
 Ast_Node_Ptr Parser::if_statement() {
-    auto if_stat = std::make_unique<Ast_If>();
-    if_stat->condition = expression();
-    if_stat->if_block = block();
-    if(!match_token({Token_Type::KW_ELSE})) {
-        return if_stat;
-    }
-    Ast_Node_Ptr else_block;                // Else block may also be just if!
-    if(match_token({Token_Type::KW_IF})) {  // Because of "else if".
-        else_block = if_statement();
-    } else {
-        else_block = std::make_unique<Ast_Block>(block());
+    auto if_stat = _arena->make<Ast_If>();
+    // "else if" chains are built in loop, generated code may have long ones.
+    for(auto current = if_stat; ; ) {
+        current->condition = expression();
+        current->if_block = block();
+        if(!match_token({Token_Type::KW_ELSE})) {
+            break;
+        }
+        if(!match_token({Token_Type::KW_IF})) {
+            current->else_block = _arena->make<Ast_Block>(block());
+            break;
+        }
+        auto else_if = _arena->make<Ast_If>();
+        current->else_block = else_if;
+        current = else_if;
     }
-    if_stat->else_block = std::move(else_block);
     return if_stat;
 }
 
 Ast_Node_Ptr Parser::while_statement() {
-    auto while_loop = std::make_unique<Ast_While>();
+    auto while_loop = _arena->make<Ast_While>();
     while_loop->condition = expression();
     while_loop->body = block();
     return while_loop;
 }
 
 Ast_Node_Ptr Parser::do_while_statement() {
-    auto do_while = std::make_unique<Ast_Do_While>();
+    auto do_while = _arena->make<Ast_Do_While>();
     do_while->body = block();
     next_token(Token_Type::KW_WHILE);
     do_while->condition = expression();
@@ -317,7 +530,7 @@ Ast_Node_Ptr Parser::do_while_statement() {
 }
 
 Ast_Node_Ptr Parser::for_statement() {
-    auto for_loop = std::make_unique<Ast_For>();
+    auto for_loop = _arena->make<Ast_For>();
     for_loop->init_statement = statement();
     for_loop->condition      = statement();
     for_loop->iteration_expr = expression();
@@ -326,296 +539,221 @@ Ast_Node_Ptr Parser::for_statement() {
 }
 
 Ast_Node_Ptr Parser::asm_block() {
-    auto inline_asm = std::make_unique<Ast_Inline_Asm>();
+    auto inline_asm = _arena->make<Ast_Inline_Asm>();
     next_token(Token_Type::L_BRACE);
     while(check_token(Token_Type::STRING)) {
-        inline_asm->operations.push_back(next_token().value);
+        inline_asm->operations.push_back(*_arena,
+                _arena->copy(_files.lexeme(next_token())));
     }
     next_token(Token_Type::R_BRACE);
     return inline_asm;
 }
 
 Ast_Node_Ptr Parser::expression() {
-    return assignment();
-}
-
-Ast_Node_Ptr Parser::assignment() {
-    auto expr = logical_or();
-    while(match_token({Token_Type::EQUALS, Token_Type::PLUS_EQUALS,
-            Token_Type::MINUS_EQUALS, Token_Type::MULTIPLY_EQUALS,
-            Token_Type::DIVIDE_EQUALS, Token_Type::MODULO_EQUALS,
-            Token_Type::AND_EQUALS, Token_Type::OR_EQUALS,
-            Token_Type::XOR_EQUALS, Token_Type::LEFT_SHIFT_EQUALS,
-            Token_Type::RIGHT_SHIFT_EQUALS})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = logical_or();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::logical_or() {
-    auto expr = logical_and();
-    while(match_token({Token_Type::LOGICAL_OR})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = logical_and();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::logical_and() {
-    auto expr = bitwise_or();
-    while(match_token({Token_Type::LOGICAL_AND})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = bitwise_or();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::bitwise_or() {
-    auto expr = bitwise_xor();
-    while(match_token({Token_Type::BITWISE_OR})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = bitwise_xor();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::bitwise_xor() {
-    auto expr = bitwise_and();
-    while(match_token({Token_Type::CARET})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = bitwise_and();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::bitwise_and() {
-    auto expr = equality();
-    while(match_token({Token_Type::AMPERSAND})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = equality();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::equality() {
-    auto expr = comparison();
-    while(match_token({Token_Type::BANG_EQUALS, Token_Type::EQUALS_EQUALS})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = comparison();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::comparison() {
-    auto expr = bitwise_shift();
-    while(match_token({Token_Type::GREATER, Token_Type::GREATER_EQUALS,
-            Token_Type::LESS, Token_Type::LESS_EQUALS})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = bitwise_shift();
-        return op;
-    }
-    return expr;
-}
-
-Ast_Node_Ptr Parser::bitwise_shift() {
-    auto expr = term();
-    while(match_token({Token_Type::BITWISE_SHIFT_LEFT,
-            Token_Type::BITWISE_SHIFT_RIGHT})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = term();
-        return op;
-    }
-    return expr;
-}
+    return expression(ASSIGNMENT);
+}
+
+// Operators waiting for their (right) operand are kept on _pending instead of
+// native stack, so deeply nested expressions can't overflow it. Every pending
+// operator remembers binding power of expression it's part of, which is
+// restored when the operator is completed.
+Ast_Node_Ptr Parser::expression(int min_power) {
+    const auto base = _pending.size();  // Expression may be nested in call.
+    int power = min_power;
+    while(true) {
+        // Prefix operators and opening parentheses wait for operand.
+        Ast_Node_Ptr prefix = nullptr;
+        int operand_power = NONE;
+        if(match_token({Token_Type::BANG, Token_Type::MINUS})) {
+            auto op = _arena->make<Ast_Unary_Operation>();
+            op->operat = _stream.peek_type(-1) == Token_Type::BANG
+                    ? Operator::NOT : Operator::NEGATE;
+            prefix = op;
+            operand_power = PREFIX;
+        } else if(match_token({Token_Type::AMPERSAND})) {
+            prefix = _arena->make<Ast_Address_Of>();
+            operand_power = POSTFIX;
+        } else if(match_token({Token_Type::CARET})) {
+            prefix = _arena->make<Ast_Ptr_Dereference>();
+            operand_power = POSTFIX;
+        } else if(match_token({Token_Type::L_PAREN})) {
+            prefix = _arena->make<Ast_Grouping_Expression>();
+            operand_power = ASSIGNMENT;
+        }
+        if(prefix != nullptr) {
+            _pending.push_back({prefix, static_cast<std::uint8_t>(power)});
+            power = operand_power;
+            continue;
+        }
 
-Ast_Node_Ptr Parser::term() {
-    auto expr = factor();
-    while(match_token({Token_Type::ASTERISK, Token_Type::SLASH,
-            Token_Type::MODULO})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = factor();
-        return op;
-    }
-    return expr;
-}
+        Ast_Node_Ptr operand;
+        if(match_token({Token_Type::KW_NEW})) {
+            auto new_stmt = _arena->make<Ast_New>();
+            new_stmt->type = type_scope_resolution();
+            operand = new_stmt;
+        } else {
+            operand = array_initializer();
+        }
 
-Ast_Node_Ptr Parser::factor() {
-    auto expr = cast();
-    while(match_token({Token_Type::PLUS, Token_Type::MINUS})) {
-        auto op = std::make_unique<Ast_Binary_Operation>();
-        op->left = std::move(expr);
-        op->operat = to_string(peek_token(-1).type);
-        op->right = cast();
-        return op;
+        // Extend operand with infix operators binding strong enough. When
+        // there's none, operand is complete and so is top pending operator.
+        while(true) {
+            const auto op = _stream.peek_type(0);
+            const auto op_power = INFIX_POWERS[static_cast<std::size_t>(op)];
+            if(op_power != NONE && op_power >= power) {
+                _stream.advance();
+                if(op_power > MULTIPLICATIVE) {     // as () [] . -> ::
+                    operand = infix_expression(operand, op);
+                    continue;
+                }
+                auto binary = _arena->make<Ast_Binary_Operation>();
+                binary->left = operand;
+                binary->operat = binary_operator(op);
+                _pending.push_back({binary, static_cast<std::uint8_t>(power)});
+                // Assignment is right associative, all other operators are
+                // left associative.
+                power = op_power == ASSIGNMENT ? op_power : op_power + 1;
+                break;
+            }
+            if(_pending.size() == base) {
+                return operand;
+            }
+            const auto pending = _pending.back();
+            _pending.pop_back();
+            complete_operator(pending.node, operand);
+            operand = pending.node;
+            power = pending.power;
+        }
     }
-    return expr;
 }
 
-Ast_Node_Ptr Parser::cast() {
-    auto expr = prefix_unary();
-    while(match_token({Token_Type::KW_AS})) {
-        auto op = std::make_unique<Ast_Cast>();
-        op->expr = std::move(expr);
-        op->to = type();
-        return op;
+void Parser::complete_operator(Ast_Node_Ptr op, Ast_Node_Ptr operand) {
+    switch(op->node_type) {
+    case Ast_Node_Type::BINARY_OPERATION:
+        node_cast<Ast_Binary_Operation>(*op).right = operand;
+        break;
+    case Ast_Node_Type::UNARY_OPERATION:
+        node_cast<Ast_Unary_Operation>(*op).left = operand;
+        break;
+    case Ast_Node_Type::ADDRESS_OF:
+        node_cast<Ast_Address_Of>(*op).expr = operand;
+        break;
+    case Ast_Node_Type::PTR_DEREFERENCE:
+        node_cast<Ast_Ptr_Dereference>(*op).expr = operand;
+        break;
+    default:
+        node_cast<Ast_Grouping_Expression>(*op).expr = operand;
+        next_token(Token_Type::R_PAREN);
     }
-    return expr;
 }
 
-Ast_Node_Ptr Parser::prefix_unary() {
-    if(match_token({Token_Type::BANG, Token_Type::MINUS})) {
-        auto op = std::make_unique<Ast_Unary_Operation>();
-        op->operat = to_string(peek_token(-1).type);
-        op->left = prefix_unary();
-        return op;
-    }
-    if(match_token({Token_Type::AMPERSAND})) {
-        auto ao = std::make_unique<Ast_Address_Of>();
-        ao->expr = postfix_unary();
-        return ao;
-    }
-    if(match_token({Token_Type::CARET})) {
-        auto deref = std::make_unique<Ast_Ptr_Dereference>();
-        deref->expr = postfix_unary();
-        return deref;
+Ast_Node_Ptr Parser::infix_expression(Ast_Node_Ptr left, Token_Type op) {
+    switch(op) {
+    case Token_Type::KW_AS: {
+        auto cast = _arena->make<Ast_Cast>();
+        cast->expr = left;
+        cast->to = type();
+        return cast;
     }
-    if(match_token({Token_Type::KW_NEW})) {
-        auto new_stmt = std::make_unique<Ast_New>();
-        new_stmt->type = type_scope_resolution();
-        return new_stmt;
-    }
-    return postfix_unary();
-}
-
-Ast_Node_Ptr Parser::postfix_unary() {
-    auto expr = array_initializer();
-    if(match_token({Token_Type::L_PAREN})) {
-        if(peek_token(-2).type != Token_Type::IDENTIFIER) {
-            // TODO:
-            report_error("Something about unexpected fdsbfuadsbf");
+    case Token_Type::L_PAREN:
+        if(left == nullptr || left->node_type != Ast_Node_Type::IDENTIFIER) {
+            report_error(Diagnostic_Id::EXPECTED_FUNCTION_NAME);
+            return left;
         }
-        return function_call(dynamic_cast<Ast_Identifier&>(*expr).name);
-    }
-    if(match_token({Token_Type::L_BRACKET})) {
-        auto aa = std::make_unique<Ast_Array_Access>();
-        aa->array = std::move(expr);
+        return function_call(node_cast<Ast_Identifier>(*left).name);
+    case Token_Type::L_BRACKET: {
+        auto aa = _arena->make<Ast_Array_Access>();
+        aa->array = left;
         aa->at = expression();
         next_token(Token_Type::R_BRACKET);
         return aa;
     }
-    // TODO: These are postfix binary :)
-    if(match_token({Token_Type::DOT})) {
-        auto ma = std::make_unique<Ast_Member_Access>();
-        ma->left = std::move(expr);
-        ma->right = postfix_unary();
+    case Token_Type::DOT: {
+        auto ma = _arena->make<Ast_Member_Access>();
+        ma->left = left;
+        ma->right = member_name();
         return ma;
     }
-    if(match_token({Token_Type::ARROW})) {
-        auto ma = std::make_unique<Ast_Member_Access>();
-        auto ptr = std::make_unique<Ast_Ptr_Dereference>();
-        ptr->expr = std::move(expr);
-        ma->left = std::move(ptr);
-        ma->right = postfix_unary();
+    case Token_Type::ARROW: {
+        auto ma = _arena->make<Ast_Member_Access>();
+        auto ptr = _arena->make<Ast_Ptr_Dereference>();
+        ptr->expr = left;
+        ma->left = ptr;
+        ma->right = member_name();
         return ma;
     }
-    return expr;
+    case Token_Type::SCOPE_RESOLUTION: {
+        auto sr = _arena->make<Ast_Scope_Resolution>();
+        sr->left = left;
+        sr->right = member_name();
+        return sr;
+    }
+    default:    // Binary operators are handled by expression().
+        return left;
+    }
+}
+
+Ast_Node_Ptr Parser::member_name() {
+    const auto name = next_token(Token_Type::IDENTIFIER).atom;
+    if(match_token({Token_Type::L_PAREN})) {
+        return function_call(name);
+    }
+    auto id = _arena->make<Ast_Identifier>();
+    id->name = name;
+    return id;
 }
 
 Ast_Node_Ptr Parser::array_initializer() {
     if(match_token({Token_Type::L_BRACKET})) {
-        auto array = std::make_unique<Ast_Array_Initializer>();
+        auto array = _arena->make<Ast_Array_Initializer>();
         if(!match_token({Token_Type::R_BRACKET})) {
             do {
-                array->values.push_back(expression());
+                array->values.push_back(*_arena, expression());
             } while(match_token({Token_Type::COMMA}));
             next_token(Token_Type::R_BRACKET);
         }
         return array;
     }
-    return scope_resolution();
-}
-
-Ast_Node_Ptr Parser::scope_resolution() {
-    auto expr = primary();
-    if(match_token({Token_Type::SCOPE_RESOLUTION})) {
-        auto sr = std::make_unique<Ast_Scope_Resolution>();
-        sr->left = std::move(expr);
-        sr->right = postfix_unary();
-        return sr;
-    }
-    return expr;
+    return primary();
 }
 
 Ast_Node_Ptr Parser::primary() {
-    auto token = peek_token(0);
+    const auto& token = peek_token(0);
     if(match_token({Token_Type::KW_TRUE})) {
-        auto b = std::make_unique<Ast_Boolean>();
+        auto b = _arena->make<Ast_Boolean>();
         b->value = true;
         return b;
     }
     if(match_token({Token_Type::KW_FALSE})) {
-        auto b = std::make_unique<Ast_Boolean>();
+        auto b = _arena->make<Ast_Boolean>();
         b->value = false;
         return b;
     }
     if(match_token({Token_Type::KW_NULL})) {
-        return std::make_unique<Ast_Null>();
+        return _arena->make<Ast_Null>();
     }
     if(match_token({Token_Type::INTEGER})) {
-        auto i = std::make_unique<Ast_Integer>();
-        i->value = std::stoll(token.value);
+        auto i = _arena->make<Ast_Integer>();
+        i->value = std::stoll(value(token));
         return i;
     }
     if(match_token({Token_Type::REAL_NUMBER})) {
-        auto r = std::make_unique<Ast_Real_Number>();
-        r->value = std::stod(token.value);
+        auto r = _arena->make<Ast_Real_Number>();
+        r->value = std::stod(value(token));
         return r;
     }
     if(match_token({Token_Type::STRING})) {
-        auto s = std::make_unique<Ast_String>();
-        s->value = token.value;
+        auto s = _arena->make<Ast_String>();
+        s->value = _arena->copy(_files.lexeme(token));
         return s;
     }
-    if(match_token({Token_Type::L_PAREN})) {
-        auto expr = std::make_unique<Ast_Grouping_Expression>();
-        expr->expr = expression();
-        next_token(Token_Type::R_PAREN);
-        return expr;
-    }
     if(match_token({Token_Type::IDENTIFIER})) {
-        auto id = std::make_unique<Ast_Identifier>();
-        id->name = token.value;
+        auto id = _arena->make<Ast_Identifier>();
+        id->name = token.atom;
         return id;
     }
-    report_error("Expected primary expression, got " + to_string(token.type));
+    report_error(Diagnostic_Id::EXPECTED_PRIMARY_EXPRESSION,
+            static_cast<std::uint32_t>(token.type));
     return nullptr;
 }
 
@@ -625,7 +763,7 @@ Ast_Node_Ptr Parser::type() {
 
 Ast_Node_Ptr Parser::type_array() {
     if(match_token({Token_Type::L_BRACKET})) {
-        auto array = std::make_unique<Ast_Array>();
+        auto array = _arena->make<Ast_Array>();
         array->type = type_array();
         if(match_token({Token_Type::COMMA})) {
             array->size = expression();
@@ -638,7 +776,7 @@ Ast_Node_Ptr Parser::type_array() {
 
 Ast_Node_Ptr Parser::type_pointer() {
     if(match_token({Token_Type::CARET})) {
-        auto op = std::make_unique<Ast_Pointer>();
+        auto op = _arena->make<Ast_Pointer>();
         op->expr = type_scope_resolution();
         return op;
     }
@@ -648,7 +786,7 @@ Ast_Node_Ptr Parser::type_pointer() {
 Ast_Node_Ptr Parser::type_scope_resolution() {
     auto expr = type_identifier();
     if(match_token({Token_Type::SCOPE_RESOLUTION})) {
-        auto sr = std::make_unique<Ast_Scope_Resolution>();
+        auto sr = _arena->make<Ast_Scope_Resolution>();
         sr->left = expression();
         sr->right = type_scope_resolution();
         return sr;
@@ -657,17 +795,20 @@ Ast_Node_Ptr Parser::type_scope_resolution() {
 }
 
 Ast_Node_Ptr Parser::type_identifier() {
-    auto name = next_token(Token_Type::IDENTIFIER).value;
-    auto id = std::make_unique<Ast_Identifier>();
+    auto name = next_token(Token_Type::IDENTIFIER).atom;
+    auto id = _arena->make<Ast_Identifier>();
     id->name = name;
     return id;
 }
 
 bool Parser::match_token(const std::initializer_list<Token_Type>& types) {
-    const auto token = peek_token(0);
+    const auto current = _stream.peek_type(0);
+    if(current == Token_Type::END_OF_FILE) {
+        return false;
+    }
     for(const auto& type : types) {
-        if(token.type == type && _current < _tokens.size()) {
-            ++_current;
+        if(current == type) {
+            _stream.advance();
             return true;
         }
     }
@@ -675,11 +816,7 @@ bool Parser::match_token(const std::initializer_list<Token_Type>& types) {
 }
 
 bool Parser::check_token(Token_Type type) const {
-    const auto token = peek_token(0);
-    if(token.type == type && _current < _tokens.size()) {
-        return true;
-    }
-    return false;
+    return _stream.peek_type(0) == type && type != Token_Type::END_OF_FILE;
 }
 
 }
@@ -1,34 +1,91 @@
 #ifndef TEZ_PARSER_H
 #define TEZ_PARSER_H
 
+#include <memory>
 #include <vector>
 
 #include "syntax/ast.h"
+#include "syntax/diagnostics.h"
+#include "syntax/file_table.h"
 #include "syntax/token.h"
+#include "syntax/token_stream.h"
 
 namespace tez {
 
+class Lexer;
+class Token_Buffer;
+
 class Parser {
 public:
-    Parser(const std::vector<Token>& tokens);
-
+    // Binding powers of operators, from the weakest.
+    enum Binding_Power : std::uint8_t {
+        NONE,
+        ASSIGNMENT,     // = += -= *= /= %= &= |= ^= <<= >>=
+        LOGICAL_OR,     // ||
+        LOGICAL_AND,    // &&
+        BITWISE_OR,     // |
+        BITWISE_XOR,    // ^
+        BITWISE_AND,    // &
+        EQUALITY,       // == !=
+        COMPARISON,     // >= <= > <
+        SHIFT,          // << >>
+        ADDITIVE,       // + -
+        MULTIPLICATIVE, // * / %
+        CAST,           // as
+        PREFIX,         // ! -
+        POSTFIX,        // () [] . ->
+        SCOPE,          // ::
+    };
+
+    // Pull tokens from lexer while parsing. Errors are reported to
+    // diagnostics; parsing stops once their limit is reached.
+    Parser(Lexer& lexer, const File_Table& files, Diagnostics& diagnostics);
+    // Parse already tokenized file; tokens must outlive parser.
+    Parser(const std::vector<Token>& tokens, const File_Table& files,
+            Diagnostics& diagnostics);
+    Parser(const Token_Buffer& tokens, const File_Table& files,
+            Diagnostics& diagnostics);
+
+    // Can be called only once; returned file owns arena with all its nodes.
     Ast_File parse();
 
+    // Update AST of file after edit, which must be already applied to file
+    // table (File_Table::edit()). Only top-level statements touched by edit
+    // are parsed again, from their beginning until parser gets back in sync
+    // with old statements; these and all before them keep their nodes. Nodes
+    // of replaced statements stay in arena until the file is destroyed.
+    // Returns false, leaving file as it was, if parsing stopped at error limit
+    // before getting back in sync; whole file has to be parsed again then.
+    static bool reparse(Ast_File& file, File_Id id, const Text_Edit& edit,
+            const File_Table& files, Diagnostics& diagnostics);
+
     bool errors_reported() const;
 
 private:
+    // Returned references point into token stream, they stay valid for
+    // Token_Stream::LOOKBEHIND more tokens. Copy token (it's 16 bytes) to keep
+    // it longer.
+
     /** Just get next token. */
-    Token next_token();
+    const Token& next_token();
     /** Validates token type and returns it. Error is reported if check fails. */
-    Token next_token(Token_Type type);
-    /** Peek token; depth = 0 returns current token. */
-    Token peek_token(size_t depth = 1) const;
+    const Token& next_token(Token_Type type);
+    /** Peek token; depth = 0 returns current token, -1 previous one. */
+    const Token& peek_token(int depth = 1) const;
     /** Check next token type. If it matches any of given types, return it. */
     bool match_token(const std::initializer_list<Token_Type>& types);
     /** Check token type; returns false if eof. */
     bool check_token(Token_Type type) const;
+    /** Copy token's text out of source buffer. */
+    std::string value(const Token& token) const;
+    /** Where current token starts, including opening quote of literals. */
+    std::uint32_t statement_begin() const;
+    /** Where the next top-level statement starts; file size at its end. */
+    std::uint32_t statement_end() const;
 
-    void report_error(const std::string& message);
+    /** Report error at previous token and skip to likely end of statement. */
+    void report_error(Diagnostic_Id id, std::uint32_t arg0 = 0,
+            std::uint32_t arg1 = 0);
 
     Ast_Node_Ptr statement();
 
@@ -39,13 +96,12 @@ private:
     Ast_Node_Ptr using_declaration();
     Ast_Node_Ptr function_declaration();
     Ast_Func_Decl::Param function_param();
-    Ast_Node_Ptr function_call(const std::string& name);
+    Ast_Node_Ptr function_call(Atom name);
     Ast_Node_Ptr variable_declaration(bool constant);
     Ast_Node_Ptr structure();
     Ast_Node_Ptr enumeration();
     Ast_Node_Ptr union_declaration();
     Ast_Node_Ptr array_initializer();
-
     Ast_Node_Ptr if_statement();
     Ast_Node_Ptr while_statement();
     Ast_Node_Ptr do_while_statement();
@@ -53,25 +109,18 @@ private:
 
     Ast_Node_Ptr asm_block();
 
-    // Recursive descent parsing. The lower the operator is in the hierarchy,
-    // the higher precedence it have. It may be very bloated implementation,
-    // but it's very safe and easy to maintain / extend.
-    Ast_Node_Ptr expression();       // Base.
-    Ast_Node_Ptr assignment();       // = += -= *= /= %=
-    Ast_Node_Ptr logical_or();       // ||
-    Ast_Node_Ptr logical_and();      // &&
-    Ast_Node_Ptr bitwise_or();       // |
-    Ast_Node_Ptr bitwise_xor();      // ^
-    Ast_Node_Ptr bitwise_and();      // &
-    Ast_Node_Ptr equality();         // == !=
-    Ast_Node_Ptr comparison();       // >= <= > <
-    Ast_Node_Ptr bitwise_shift();    // << >>
-    Ast_Node_Ptr term();             // * / %
-    Ast_Node_Ptr factor();           // + -
-    Ast_Node_Ptr cast();             // 'as'
-    Ast_Node_Ptr prefix_unary();     // ! -
-    Ast_Node_Ptr postfix_unary();    // () [] . ->
-    Ast_Node_Ptr scope_resolution(); // ::
+    // Expressions are parsed by precedence climbing (Pratt parser), driven by
+    // binding powers of operators (see parser.cc). Prefix and binary
+    // operators and parentheses use explicit stack instead of recursion.
+    Ast_Node_Ptr expression();
+    /** Parse expression whose operators bind at least as strong as min_power. */
+    Ast_Node_Ptr expression(int min_power);
+    /** Set operand of prefix or binary operator or parentheses. */
+    void complete_operator(Ast_Node_Ptr op, Ast_Node_Ptr operand);
+    /** Postfix operators and ones with non-expression right side. */
+    Ast_Node_Ptr infix_expression(Ast_Node_Ptr left, Token_Type op);
+    /** Right side of '.', '->' and '::': identifier or function call. */
+    Ast_Node_Ptr member_name();
     Ast_Node_Ptr primary();          // int, double, bool, null, identifier
 
     // Types also are parsed using recursive descent parsing, completely
@@ -82,8 +131,19 @@ private:
     Ast_Node_Ptr type_scope_resolution();   // ::
     Ast_Node_Ptr type_identifier();         // identifier
 
-    const std::vector<Token> _tokens;
-    unsigned int             _current = 0;
+    Token_Stream               _stream;
+    const File_Table&          _files;
+    Diagnostics&               _diagnostics;
+    std::unique_ptr<Ast_Arena> _arena = std::make_unique<Ast_Arena>();
+    // Error recovery moves past mismatched token, it's kept here for
+    // next_token(type) to return.
+    Token                      _mismatched{};
+
+    struct Pending_Operator {
+        Ast_Node_Ptr node;      // Operand isn't set yet.
+        std::uint8_t power;     // Minimal power of expression it belongs to.
+    };
+    std::vector<Pending_Operator> _pending;     // Shared by nested expressions.
 
     bool _errors_reported = false;
 };
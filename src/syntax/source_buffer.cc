@@ -0,0 +1,161 @@
+#include "source_buffer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tez {
+
+namespace {
+
+// Read everything from given descriptor. Used for pipes and stdin, whose size
+// isn't known up front, so storage grows geometrically. Unused tail stays
+// zeroed, so there is always room for padding. Returns null if read fails,
+// errno tells why.
+std::unique_ptr<char[]> read_all(int fd, std::size_t& size) {
+    std::size_t capacity = 64 * 1024;
+    auto buffer = std::make_unique<char[]>(capacity);
+    size = 0;
+    for(;;) {
+        if(capacity - size < Source_Buffer::PADDING) {
+            auto bigger = std::make_unique<char[]>(capacity * 2);
+            std::memcpy(bigger.get(), buffer.get(), size);
+            buffer = std::move(bigger);
+            capacity *= 2;
+        }
+        auto n = ::read(fd, buffer.get() + size,
+                capacity - size - Source_Buffer::PADDING);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n < 0) {
+            return nullptr;
+        }
+        if(n == 0) {
+            break;
+        }
+        size += static_cast<std::size_t>(n);
+    }
+    return buffer;
+}
+
+// Map file followed by zeroed padding. Whole range is reserved as anonymous
+// (zero-filled) memory first and file is mapped over its beginning; bytes
+// between end of file and end of its last page are zeroed by kernel.
+const char* map_padded(int fd, std::size_t size, std::size_t& mapped_size) {
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    mapped_size = (size + Source_Buffer::PADDING + page - 1) / page * page;
+    void* region = ::mmap(nullptr, mapped_size, PROT_READ,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(region == MAP_FAILED) {
+        return nullptr;
+    }
+    void* file = ::mmap(region, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd,
+            0);
+    if(file == MAP_FAILED) {
+        ::munmap(region, mapped_size);
+        return nullptr;
+    }
+    ::madvise(file, size, MADV_SEQUENTIAL);
+    return static_cast<const char*>(file);
+}
+
+}
+
+const char Source_Buffer::EMPTY[PADDING]{};
+
+Source_Buffer::~Source_Buffer() {
+    release();
+}
+
+Source_Buffer::Source_Buffer(Source_Buffer&& other) noexcept
+        : _data{std::exchange(other._data, EMPTY)},
+          _size{std::exchange(other._size, 0)},
+          _mapped_size{std::exchange(other._mapped_size, 0)},
+          _owned{std::move(other._owned)} {
+}
+
+Source_Buffer& Source_Buffer::operator=(Source_Buffer&& other) noexcept {
+    if(this != &other) {
+        release();
+        _data = std::exchange(other._data, EMPTY);
+        _size = std::exchange(other._size, 0);
+        _mapped_size = std::exchange(other._mapped_size, 0);
+        _owned = std::move(other._owned);
+    }
+    return *this;
+}
+
+void Source_Buffer::release() {
+    if(_mapped_size != 0) {
+        ::munmap(const_cast<char*>(_data), _mapped_size);
+    }
+    _owned.reset();
+    _data = EMPTY;
+    _size = 0;
+    _mapped_size = 0;
+}
+
+Source_Buffer Source_Buffer::from_file(const std::string& filename) {
+    const bool use_stdin = filename == "-";
+    int fd = use_stdin ? STDIN_FILENO : ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw File_Not_Found{"Failed to open file \"" + filename + "\""};
+    }
+    Source_Buffer buffer;
+    struct stat info{};
+    if(::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        const auto size = static_cast<std::size_t>(info.st_size);
+        if(auto data = map_padded(fd, size, buffer._mapped_size)) {
+            buffer._data = data;
+            buffer._size = size;
+            if(!use_stdin) {
+                ::close(fd);
+            }
+            return buffer;
+        }
+        buffer._mapped_size = 0;
+    }
+    // Not a regular file (or mmap failed), fall back to reading.
+    buffer._owned = read_all(fd, buffer._size);
+    const auto error = errno;
+    if(!use_stdin) {
+        ::close(fd);
+    }
+    if(buffer._owned == nullptr) {
+        buffer._size = 0;
+        throw File_Not_Found{"Failed to read file \"" + filename + "\": "
+                + std::strerror(error)};
+    }
+    buffer._data = buffer._owned.get();
+    return buffer;
+}
+
+Source_Buffer Source_Buffer::from_string(std::string_view content) {
+    return from_strings({content});
+}
+
+Source_Buffer Source_Buffer::from_strings(
+        std::initializer_list<std::string_view> parts) {
+    Source_Buffer buffer;
+    for(const auto& part : parts) {
+        buffer._size += part.size();
+    }
+    // Not value-initialized, content is written right away.
+    buffer._owned.reset(new char[buffer._size + PADDING]);
+    char* out = buffer._owned.get();
+    for(const auto& part : parts) {
+        std::memcpy(out, part.data(), part.size());
+        out += part.size();
+    }
+    std::memset(out, 0, PADDING);
+    buffer._data = buffer._owned.get();
+    return buffer;
+}
+
+}
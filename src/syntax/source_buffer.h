@@ -0,0 +1,62 @@
+#ifndef TEZ_SOURCE_BUFFER_H
+#define TEZ_SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace tez {
+
+class File_Not_Found : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// Read-only, immovable-in-memory content of a single source file.
+// Regular files are memory-mapped, so loading them costs only page faults.
+// Pipes, character devices and stdin can't be mapped; these are read with
+// one bulk read into owned storage instead.
+// Content is always followed by PADDING zero bytes, so data()[size()] is NUL
+// sentinel and vector loads may safely run past the end.
+class Source_Buffer {
+public:
+    static constexpr std::size_t PADDING = 64;
+
+    Source_Buffer() = default;
+    ~Source_Buffer();
+
+    Source_Buffer(Source_Buffer&& other) noexcept;
+    Source_Buffer& operator=(Source_Buffer&& other) noexcept;
+    Source_Buffer(const Source_Buffer&) = delete;
+    Source_Buffer& operator=(const Source_Buffer&) = delete;
+
+    // Map (or read) given file; "-" means standard input.
+    // Throws File_Not_Found if file can't be opened or read.
+    static Source_Buffer from_file(const std::string& filename);
+    // Copy given source code into owned buffer.
+    static Source_Buffer from_string(std::string_view content);
+    // Same, for source code split into several parts.
+    static Source_Buffer from_strings(
+            std::initializer_list<std::string_view> parts);
+
+    std::string_view view() const { return {_data, _size}; }
+    const char* data() const { return _data; }
+    std::size_t size() const { return _size; }
+    bool is_mapped() const { return _mapped_size != 0; }
+
+private:
+    void release();
+
+    static const char EMPTY[PADDING];
+
+    const char*             _data = EMPTY;
+    std::size_t             _size = 0;
+    std::size_t             _mapped_size = 0;   // Zero if not mapped.
+    std::unique_ptr<char[]> _owned;     // Used when file is not mapped.
+};
+
+}
+
+#endif //TEZ_SOURCE_BUFFER_H
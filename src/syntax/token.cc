@@ -53,6 +53,7 @@ std::string to_string(Token_Type token_type) {
         case Token_Type::KW_IF:               result = "if";          break;
         case Token_Type::KW_STRUCT:           result = "if";          break;
         case Token_Type::KW_ENUM:             result = "if";          break;
+        case Token_Type::END_OF_FILE:         result = "end of file"; break;
         default:                              result = "not implemented yet";
     }
     return result;
@@ -1,11 +1,15 @@
 #ifndef TEZ_TOKEN_H
 #define TEZ_TOKEN_H
 
+#include <cstdint>
+#include <limits>
 #include <string>
 
+#include "utils/atom_table.h"
+
 namespace tez {
 
-enum class Token_Type {
+enum class Token_Type : std::uint8_t {
     IDENTIFIER,
 
     INTEGER,
@@ -82,14 +86,26 @@ enum class Token_Type {
     AMPERSAND,
     CARET,
     ARROW,
+
+    END_OF_FILE,
 };
 
+// Index into File_Table.
+using File_Id = std::uint16_t;
+// Reserved, no file gets this id; marks diagnostics without source location.
+constexpr File_Id NO_FILE = std::numeric_limits<File_Id>::max();
+
+// Token doesn't own its text, lexeme is range [offset, offset + length) of
+// file's source buffer (see File_Table::lexeme()). For strings and characters
+// it's the content between quotes. Identifiers are interned while lexing.
+// Line and column are computed from offset only when needed for diagnostic
+// (see File_Table::location()).
 struct Token {
-    Token_Type   type;
-    std::string  value;
-    std::string  filename;
-    unsigned int line;
-    unsigned int column;
+    Token_Type    type;
+    File_Id       file;
+    std::uint32_t offset;
+    std::uint32_t length;
+    Atom          atom;     // Only for identifiers.
 };
 
 std::string to_string(Token_Type token_type);
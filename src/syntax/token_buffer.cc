@@ -0,0 +1,41 @@
+#include "token_buffer.h"
+
+#include "syntax/lexer.h"
+
+namespace tez {
+
+Token_Buffer::Token_Buffer(Lexer& lexer) {
+    for(auto token = lexer.next(); token.type != Token_Type::END_OF_FILE;
+            token = lexer.next()) {
+        push(token);
+    }
+    _types.shrink_to_fit();
+    _offsets.shrink_to_fit();
+    _payloads.shrink_to_fit();
+}
+
+void Token_Buffer::push(const Token& token) {
+    _file = token.file;
+    _types.push_back(token.type);
+    _offsets.push_back(token.offset);
+    _payloads.push_back(token.type == Token_Type::IDENTIFIER
+            ? static_cast<std::uint32_t>(token.atom) : token.length);
+}
+
+Token Token_Buffer::operator[](std::size_t index) const {
+    Token token{_types[index], _file, _offsets[index], _payloads[index],
+            Atom{}};
+    if(token.type == Token_Type::IDENTIFIER) {
+        token.atom = static_cast<Atom>(_payloads[index]);
+        token.length = static_cast<std::uint32_t>(atom_name(token.atom).size());
+    }
+    return token;
+}
+
+std::size_t Token_Buffer::memory_usage() const {
+    return _types.capacity() * sizeof(Token_Type)
+            + _offsets.capacity() * sizeof(std::uint32_t)
+            + _payloads.capacity() * sizeof(std::uint32_t);
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef TEZ_TOKEN_BUFFER_H
+#define TEZ_TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "syntax/token.h"
+
+namespace tez {
+
+class Lexer;
+
+// Tokens of one file kept as struct of arrays. Parser looks mostly at token
+// types only, so they are stored densely, one byte each - single cache line
+// covers 64 tokens of lookahead. Offset and length (atom for identifiers,
+// length is recovered from its name) add 8 bytes per token, compared to 16
+// bytes of Token.
+class Token_Buffer {
+public:
+    Token_Buffer() = default;
+    // Lex whole file; END_OF_FILE is not stored.
+    explicit Token_Buffer(Lexer& lexer);
+
+    void push(const Token& token);
+
+    // Rebuild full token.
+    Token operator[](std::size_t index) const;
+    Token_Type type(std::size_t index) const { return _types[index]; }
+
+    std::size_t size() const { return _types.size(); }
+    bool empty() const { return _types.empty(); }
+    // Bytes taken by token data.
+    std::size_t memory_usage() const;
+
+private:
+    File_Id                    _file = 0;
+    std::vector<Token_Type>    _types;
+    std::vector<std::uint32_t> _offsets;
+    std::vector<std::uint32_t> _payloads;   // Length, or atom for identifier.
+};
+
+}
+
+#endif //TEZ_TOKEN_BUFFER_H
@@ -0,0 +1,93 @@
+#include "token_stream.h"
+
+#include "syntax/lexer.h"
+#include "syntax/token_buffer.h"
+
+namespace tez {
+
+Token_Stream::Token_Stream(Lexer& lexer)
+        : _lexer{&lexer} {
+    _eof.type = Token_Type::END_OF_FILE;
+    for(int i = 0; i <= LOOKAHEAD; ++i) {
+        pull();
+    }
+}
+
+Token_Stream::Token_Stream(const std::vector<Token>& tokens)
+        : _tokens{tokens.data()}, _count{tokens.size()} {
+    _eof.type = Token_Type::END_OF_FILE;
+    if(!tokens.empty()) {
+        const auto& last = tokens.back();
+        _eof.file = last.file;
+        _eof.offset = last.offset + last.length;
+    }
+}
+
+Token_Stream::Token_Stream(const Token_Buffer& tokens)
+        : _buffer{&tokens} {
+    _eof.type = Token_Type::END_OF_FILE;
+    if(!tokens.empty()) {
+        const auto last = tokens[tokens.size() - 1];
+        _eof.file = last.file;
+        _eof.offset = last.offset + last.length;
+    }
+    for(int i = 0; i <= LOOKAHEAD; ++i) {
+        pull();
+    }
+}
+
+const Token& Token_Stream::peek(int depth) const {
+    if(depth < -static_cast<int>(_current)) {   // Before first token.
+        return _eof;
+    }
+    const auto index = _current + depth;
+    if(_tokens == nullptr) {
+        if(index >= _pulled) {
+            return _ring[(_pulled - 1) % RING_SIZE];    // Last is EOF.
+        }
+        return _ring[index % RING_SIZE];
+    }
+    if(index >= _count) {
+        return _eof;
+    }
+    return _tokens[index];
+}
+
+Token_Type Token_Stream::peek_type(int depth) const {
+    if(_buffer == nullptr) {
+        return peek(depth).type;
+    }
+    const auto index = _current + depth;
+    if(depth < -static_cast<int>(_current) || index >= _buffer->size()) {
+        return Token_Type::END_OF_FILE;
+    }
+    return _buffer->type(index);
+}
+
+void Token_Stream::advance() {
+    if(at_end()) {
+        return;
+    }
+    ++_current;
+    if(_tokens == nullptr) {
+        pull();
+    }
+}
+
+void Token_Stream::pull() {
+    if(_pulled > 0) {
+        const auto& last = _ring[(_pulled - 1) % RING_SIZE];
+        if(last.type == Token_Type::END_OF_FILE) {
+            return;     // Lexer is done, last token stays EOF.
+        }
+    }
+    auto& slot = _ring[_pulled % RING_SIZE];
+    if(_lexer != nullptr) {
+        slot = _lexer->next();
+    } else {
+        slot = _pulled < _buffer->size() ? (*_buffer)[_pulled] : _eof;
+    }
+    ++_pulled;
+}
+
+}
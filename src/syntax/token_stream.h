@@ -0,0 +1,62 @@
+#ifndef TEZ_TOKEN_STREAM_H
+#define TEZ_TOKEN_STREAM_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "syntax/token.h"
+
+namespace tez {
+
+class Lexer;
+class Token_Buffer;
+
+// Sliding window over tokens consumed by Parser. When created from Lexer,
+// tokens are pulled on demand into small ring buffer, so lexing and parsing
+// run interleaved and only LOOKBEHIND + LOOKAHEAD + 1 tokens exist at once.
+// Compact Token_Buffer is unpacked into the same ring. Plain vector of tokens
+// is walked in place.
+class Token_Stream {
+public:
+    // How far back and forward peek() may look from current token.
+    static constexpr int LOOKBEHIND = 2;
+    static constexpr int LOOKAHEAD = 1;
+
+    explicit Token_Stream(Lexer& lexer);
+    // Tokens are not copied, vector must outlive the stream.
+    explicit Token_Stream(const std::vector<Token>& tokens);
+    explicit Token_Stream(const Token_Buffer& tokens);
+
+    // depth = 0 is current token, it must be in [-LOOKBEHIND, LOOKAHEAD].
+    // Outside of the file END_OF_FILE is returned. Reference stays valid for
+    // at least LOOKBEHIND calls to advance().
+    const Token& peek(int depth) const;
+    // Same as peek(depth).type, but for Token_Buffer touches only types.
+    Token_Type peek_type(int depth) const;
+    // Move to next token; does nothing at the end of file.
+    void advance();
+    bool at_end() const { return peek_type(0) == Token_Type::END_OF_FILE; }
+
+private:
+    static constexpr std::size_t RING_SIZE = 8;     // Power of 2.
+    static_assert(LOOKBEHIND + LOOKAHEAD + 1 <= static_cast<int>(RING_SIZE));
+
+    void pull();
+
+    Lexer*                        _lexer = nullptr;
+    std::array<Token, RING_SIZE>  _ring{};
+    std::size_t                   _pulled = 0;      // Tokens taken from lexer.
+
+    const Token_Buffer*           _buffer = nullptr;
+
+    const Token*                  _tokens = nullptr;    // Walked in place.
+    std::size_t                   _count = 0;
+
+    std::size_t _current = 0;
+    Token       _eof{};
+};
+
+}
+
+#endif //TEZ_TOKEN_STREAM_H
@@ -0,0 +1,129 @@
+#include "atom_table.h"
+
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace tez {
+
+namespace {
+
+constexpr std::size_t STORAGE_BLOCK_SIZE = 64 * 1024;
+
+}
+
+Atom_Table::Atom_Table()
+        : _chunks{std::make_unique<std::atomic<Chunk*>[]>(MAX_CHUNKS)} {
+    intern("");     // Atom{} is empty string.
+}
+
+Atom_Table& Atom_Table::global() {
+    static Atom_Table table;
+    return table;
+}
+
+Atom Atom_Table::intern(std::string_view s) {
+    auto& shard = _shards[std::hash<std::string_view>{}(s) % SHARDS];
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    if(auto it = shard.atoms.find(s); it != shard.atoms.end()) {
+        return it->second;
+    }
+    const std::string_view stored{store(shard, s), s.size()};
+    const auto atom = publish(stored);
+    shard.atoms.emplace(stored, atom);
+    return atom;
+}
+
+std::string_view Atom_Table::name(Atom atom) const {
+    const auto id = static_cast<std::size_t>(atom);
+    const auto& slot = _chunks[id / CHUNK_SIZE];
+    const auto* chunk = slot.load(std::memory_order_acquire);
+    return (*chunk)[id % CHUNK_SIZE];
+}
+
+const char* Atom_Table::store(Shard& shard, std::string_view s) {
+    if(s.empty()) {
+        return "";
+    }
+    if(s.size() > STORAGE_BLOCK_SIZE / 4) {     // Don't waste blocks.
+        shard.storage.push_back(std::make_unique<char[]>(s.size()));
+        std::memcpy(shard.storage.back().get(), s.data(), s.size());
+        return shard.storage.back().get();
+    }
+    if(shard.storage_left < s.size()) {
+        shard.storage.push_back(std::make_unique<char[]>(STORAGE_BLOCK_SIZE));
+        shard.storage_cursor = shard.storage.back().get();
+        shard.storage_left = STORAGE_BLOCK_SIZE;
+    }
+    char* destination = shard.storage_cursor;
+    std::memcpy(destination, s.data(), s.size());
+    shard.storage_cursor += s.size();
+    shard.storage_left -= s.size();
+    return destination;
+}
+
+Atom Atom_Table::publish(std::string_view s) {
+    std::lock_guard<std::mutex> lock{_chunks_mutex};
+    const auto id = _count.load(std::memory_order_relaxed);
+    if(id / CHUNK_SIZE >= MAX_CHUNKS) {
+        throw std::length_error{"Too many distinct identifiers."};
+    }
+    auto& slot = _chunks[id / CHUNK_SIZE];
+    auto* chunk = slot.load(std::memory_order_relaxed);
+    if(chunk == nullptr) {
+        _owned_chunks.push_back(std::make_unique<Chunk>());
+        chunk = _owned_chunks.back().get();
+    }
+    (*chunk)[id % CHUNK_SIZE] = s;
+    // Release makes the string visible to anyone who sees the new count or
+    // gets the atom through synchronized channel.
+    slot.store(chunk, std::memory_order_release);
+    _count.store(id + 1, std::memory_order_release);
+    return static_cast<Atom>(id);
+}
+
+Atom Atom_Cache::intern(std::string_view s) {
+    const auto mask = _entries.size() - 1;
+    for(auto i = hash(s) & mask;; i = (i + 1) & mask) {
+        auto& entry = _entries[i];
+        if(!entry.used) {
+            entry = {s, _table.intern(s), true};
+            if(++_used * 2 > _entries.size()) {
+                const auto atom = entry.atom;
+                grow();
+                return atom;
+            }
+            return entry.atom;
+        }
+        if(entry.text == s) {
+            return entry.atom;
+        }
+    }
+}
+
+// FNV-1a; identifiers are short, so anything fancier doesn't pay off.
+std::size_t Atom_Cache::hash(std::string_view s) {
+    std::uint64_t h = 14695981039346656037ull;
+    for(char c : s) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+void Atom_Cache::grow() {
+    std::vector<Entry> old(_entries.size() * 2);
+    old.swap(_entries);
+    const auto mask = _entries.size() - 1;
+    for(const auto& entry : old) {
+        if(!entry.used) {
+            continue;
+        }
+        auto i = hash(entry.text) & mask;
+        while(_entries[i].used) {
+            i = (i + 1) & mask;
+        }
+        _entries[i] = entry;
+    }
+}
+
+}
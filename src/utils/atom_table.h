@@ -0,0 +1,104 @@
+#ifndef TEZ_ATOM_TABLE_H
+#define TEZ_ATOM_TABLE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tez {
+
+// Interned string. Equal strings always get the same atom, so names can be
+// compared and hashed as integers. Atom{} is empty string.
+enum class Atom : std::uint32_t {};
+
+// Thread safe string interner. Interned strings are never freed nor moved,
+// so views returned by name() stay valid for the lifetime of the table.
+class Atom_Table {
+public:
+    Atom_Table();
+    Atom_Table(const Atom_Table&) = delete;
+    Atom_Table& operator=(const Atom_Table&) = delete;
+
+    // Table shared by lexer, parser and semantic analysis.
+    static Atom_Table& global();
+
+    Atom intern(std::string_view s);
+    // Atom has to come from this table.
+    std::string_view name(Atom atom) const;
+    std::size_t size() const { return _count.load(std::memory_order_acquire); }
+
+private:
+    // Strings are distributed over shards by hash, so threads lexing
+    // different files rarely wait for each other.
+    struct Shard {
+        std::mutex                                   mutex;
+        std::unordered_map<std::string_view, Atom>   atoms;
+        std::vector<std::unique_ptr<char[]>>         storage;
+        char*                                        storage_cursor = nullptr;
+        std::size_t                                  storage_left = 0;
+    };
+
+    // Atom -> string lookup goes through fixed directory of chunks, so it's
+    // lock free; chunks are allocated when needed and never move.
+    static constexpr std::size_t CHUNK_SIZE = 1 << 14;
+    static constexpr std::size_t MAX_CHUNKS = 1 << 14;
+    static constexpr std::size_t SHARDS = 16;
+
+    using Chunk = std::array<std::string_view, CHUNK_SIZE>;
+
+    const char* store(Shard& shard, std::string_view s);
+    Atom publish(std::string_view s);
+
+    std::array<Shard, SHARDS>                       _shards;
+    std::unique_ptr<std::atomic<Chunk*>[]>          _chunks;
+    std::vector<std::unique_ptr<Chunk>>             _owned_chunks;
+    std::mutex                                      _chunks_mutex;
+    std::atomic<std::uint32_t>                      _count{0};
+};
+
+// Unsynchronized front for Atom_Table, owned by single thread (e.g. one per
+// Lexer). Identifiers repeat a lot, so most lookups end here without locking.
+// Cached views must outlive the cache (they point into source buffer).
+class Atom_Cache {
+public:
+    explicit Atom_Cache(Atom_Table& table) : _table{table} {}
+
+    Atom intern(std::string_view s);
+
+private:
+    struct Entry {
+        std::string_view text;
+        Atom             atom{};
+        bool             used = false;
+    };
+
+    static std::size_t hash(std::string_view s);
+    void grow();
+
+    Atom_Table&        _table;
+    std::vector<Entry> _entries = std::vector<Entry>(256);  // Power of 2.
+    std::size_t        _used = 0;
+};
+
+// Shortcuts for global table.
+inline Atom intern(std::string_view s) {
+    return Atom_Table::global().intern(s);
+}
+
+inline std::string_view atom_name(Atom atom) {
+    return Atom_Table::global().name(atom);
+}
+
+inline std::ostream& operator<<(std::ostream& os, Atom atom) {
+    return os << atom_name(atom);
+}
+
+}
+
+#endif //TEZ_ATOM_TABLE_H
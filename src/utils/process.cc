@@ -0,0 +1,59 @@
+#include "process.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+namespace tez {
+
+Process::Process(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for(const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    const auto error = ::posix_spawnp(&_pid, argv[0], nullptr, nullptr,
+            argv.data(), environ);
+    if(error != 0) {
+        _pid = -1;
+        throw std::system_error{error, std::generic_category(),
+                "Failed to run \"" + args[0] + "\""};
+    }
+}
+
+Process::Process(Process&& other) noexcept
+        : _pid{other._pid}, _status{other._status} {
+    other._pid = -1;
+}
+
+Process::~Process() {
+    wait();
+}
+
+int Process::wait() {
+    if(_pid < 0) {
+        return _status;
+    }
+    int status = 0;
+    while(::waitpid(_pid, &status, 0) < 0) {
+        if(errno != EINTR) {
+            // Process can't be reaped, its result is unknown.
+            _pid = -1;
+            _status = FAILED;
+            return _status;
+        }
+    }
+    _pid = -1;
+    if(WIFEXITED(status)) {
+        _status = WEXITSTATUS(status);
+    } else if(WIFSIGNALED(status)) {
+        _status = 128 + WTERMSIG(status);
+    }
+    return _status;
+}
+
+}
@@ -0,0 +1,39 @@
+#ifndef TEZ_PROCESS_H
+#define TEZ_PROCESS_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace tez {
+
+// Child process, e.g. C compiler. It runs alongside the compiler until
+// wait(); stdin, stdout and stderr are shared with compiler.
+class Process {
+public:
+    // args[0] is program, searched in PATH. Throws std::system_error if it
+    // can't be started.
+    explicit Process(const std::vector<std::string>& args);
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+    Process(Process&& other) noexcept;
+    Process& operator=(Process&& other) = delete;
+    // Waits, so no process is left behind.
+    ~Process();
+
+    // Status of process whose end couldn't be observed.
+    static constexpr int FAILED = -1;
+
+    // Block until process ends. Returns exit status, or 128 + signal number
+    // if process was killed, or FAILED; repeated calls return the same status.
+    int wait();
+
+private:
+    pid_t _pid = -1;
+    int   _status = FAILED;     // Until process is reaped.
+};
+
+}
+
+#endif //TEZ_PROCESS_H
@@ -0,0 +1,89 @@
+#include "thread_pool.h"
+
+#include <utility>
+
+namespace tez {
+
+Thread_Pool::Thread_Pool(std::size_t threads) {
+    if(threads < 2) {
+        return;
+    }
+    _workers.reserve(threads);
+    for(std::size_t i = 0; i < threads; ++i) {
+        _workers.emplace_back([this] { work(); });
+    }
+}
+
+Thread_Pool::~Thread_Pool() {
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _stopping = true;
+    }
+    _task_added.notify_all();
+    for(auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void Thread_Pool::submit(std::function<void()> task) {
+    if(_workers.empty()) {
+        run(task);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _tasks.push_back(std::move(task));
+        ++_unfinished;
+    }
+    _task_added.notify_one();
+}
+
+void Thread_Pool::wait() {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _task_finished.wait(lock, [this] { return _unfinished == 0; });
+    if(_exception) {
+        std::rethrow_exception(std::exchange(_exception, nullptr));
+    }
+}
+
+std::size_t Thread_Pool::hardware_threads() {
+    const auto threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+void Thread_Pool::work() {
+    while(true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            // Queue is drained before stopping.
+            _task_added.wait(lock, [this] {
+                return _stopping || !_tasks.empty();
+            });
+            if(_tasks.empty()) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        run(task);
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            --_unfinished;
+        }
+        _task_finished.notify_all();
+    }
+}
+
+void Thread_Pool::run(const std::function<void()>& task) {
+    try {
+        task();
+    } catch(...) {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if(!_exception) {
+            _exception = std::current_exception();
+        }
+    }
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef TEZ_THREAD_POOL_H
+#define TEZ_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tez {
+
+// Fixed set of worker threads running submitted tasks in FIFO order. With
+// less than 2 threads there are no workers and tasks run immediately in
+// submit(), so single threaded compilation doesn't pay for synchronization.
+class Thread_Pool {
+public:
+    explicit Thread_Pool(std::size_t threads);
+    Thread_Pool(const Thread_Pool&) = delete;
+    Thread_Pool& operator=(const Thread_Pool&) = delete;
+    // Waits for queued tasks.
+    ~Thread_Pool();
+
+    void submit(std::function<void()> task);
+    // Block until all submitted tasks are finished. If any of them threw,
+    // first exception is rethrown here.
+    void wait();
+
+    std::size_t size() const { return _workers.size(); }
+
+    // Number of threads for "use all cores".
+    static std::size_t hardware_threads();
+
+private:
+    void work();
+    void run(const std::function<void()>& task);
+
+    std::vector<std::thread>          _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex                        _mutex;
+    std::condition_variable           _task_added;
+    std::condition_variable           _task_finished;
+    std::size_t                       _unfinished = 0;  // Queued or running.
+    bool                              _stopping = false;
+    std::exception_ptr                _exception;
+};
+
+}
+
+#endif //TEZ_THREAD_POOL_H
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "syntax/ast_arena.h"
+
+TEST(Ast_Arena, Alignment) {
+    tez::Ast_Arena arena;
+    arena.allocate(1, 1);
+    const auto p = arena.allocate(sizeof(double), alignof(double));
+
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignof(double), 0);
+}
+
+TEST(Ast_Arena, Big_Allocation) {
+    tez::Ast_Arena arena;
+    const auto small = static_cast<char*>(arena.allocate(16, 1));
+    const auto big = static_cast<char*>(arena.allocate(1024 * 1024, 1));
+    big[1024 * 1024 - 1] = 'x';
+    const auto next = static_cast<char*>(arena.allocate(16, 1));
+
+    ASSERT_GE(arena.capacity(), 1024 * 1024);
+    ASSERT_EQ(next, small + 16);    // Rest of first block is still used.
+}
+
+TEST(Ast_Arena, List_Growth) {
+    tez::Ast_Arena arena;
+    tez::Ast_List<int> list;
+    for(int i = 0; i < 1000; ++i) {
+        list.push_back(arena, i);
+    }
+
+    ASSERT_EQ(list.size(), 1000);
+    for(int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(list[i], i);
+    }
+}
+
+TEST(Ast_Arena, Copy_String) {
+    tez::Ast_Arena arena;
+    std::string text = "hello";
+    const auto copy = arena.copy(text);
+    text[0] = 'j';
+
+    ASSERT_EQ(copy, "hello");
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include "syntax/ast_visitor.h"
+#include "syntax/lexer.h"
+#include "syntax/parser.h"
+
+namespace {
+
+// Counts literals and binary operations of expression, other nodes stop walk.
+struct Literal_Counter : tez::Ast_Visitor<Literal_Counter, int> {
+    int visit_node([[maybe_unused]] const tez::Ast_Integer& node) {
+        return 1;
+    }
+    int visit_node(const tez::Ast_Binary_Operation& node) {
+        ++operations;
+        return visit(*node.left) + visit(*node.right);
+    }
+    int visit_node([[maybe_unused]] const tez::Ast_Node& node) {
+        ++others;
+        return 0;
+    }
+
+    int operations = 0;
+    int others = 0;
+};
+
+}
+
+TEST(Ast_Visitor, Dispatch_On_Node_Type) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", "1 + 2 * a - 3;"), diagnostics};
+    tez::Parser parser{lexer, files, diagnostics};
+    const auto file_unit = parser.parse();
+    ASSERT_EQ(file_unit.statements.size(), 1);
+
+    Literal_Counter counter;
+    ASSERT_EQ(counter.visit(*file_unit.statements[0]), 3);
+    ASSERT_EQ(counter.operations, 3);
+    ASSERT_EQ(counter.others, 1);
+    ASSERT_EQ(counter.visit(file_unit), 0);
+    ASSERT_EQ(counter.others, 2);
+}
+
+TEST(Ast_Visitor, Node_Cast) {
+    tez::Ast_Integer integer;
+    integer.value = 42;
+    const tez::Ast_Node& node = integer;
+    ASSERT_EQ(tez::node_cast<tez::Ast_Integer>(node).value, 42);
+    ASSERT_EQ(tez::Ast_Integer::TYPE, tez::Ast_Node_Type::INTEGER);
+}
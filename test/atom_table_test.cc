@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/atom_table.h"
+
+TEST(Atom_Table, Same_String_Same_Atom) {
+    tez::Atom_Table table;
+    auto a = table.intern("compiler");
+    auto b = table.intern(std::string{"compi"} + "ler");
+    auto c = table.intern("lexer");
+
+    ASSERT_EQ(a, b);
+    ASSERT_NE(a, c);
+    ASSERT_EQ(table.name(a), "compiler");
+    ASSERT_EQ(table.name(c), "lexer");
+}
+
+TEST(Atom_Table, Empty_String_Is_Default_Atom) {
+    tez::Atom_Table table;
+    ASSERT_EQ(table.intern(""), tez::Atom{});
+    ASSERT_EQ(table.name(tez::Atom{}), "");
+}
+
+TEST(Atom_Table, Concurrent_Interning) {
+    tez::Atom_Table table;
+    constexpr int THREADS = 4;
+    constexpr int NAMES = 20000;
+    std::vector<std::vector<tez::Atom>> results(THREADS);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&table, &results, t] {
+            for(int i = 0; i < NAMES; ++i) {
+                results[t].push_back(table.intern("name_" + std::to_string(i)));
+            }
+        });
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(table.size(), NAMES + 1);     // Plus empty string.
+    for(int t = 1; t < THREADS; ++t) {
+        ASSERT_EQ(results[t], results[0]);
+    }
+    for(int i = 0; i < NAMES; ++i) {
+        ASSERT_EQ(table.name(results[0][i]), "name_" + std::to_string(i));
+    }
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "codegen/c_codegen.h"
+#include "syntax/lexer.h"
+#include "syntax/parser.h"
+#include "utils/thread_pool.h"
+
+namespace {
+
+tez::Ast_File parse(tez::File_Table& files, tez::Diagnostics& diagnostics,
+        const std::string& input) {
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    return tez::Parser{lexer, files, diagnostics}.parse();
+}
+
+std::string generate(const tez::Ast& ast, std::size_t threads) {
+    tez::C_Writer out;
+    tez::Thread_Pool pool{threads};
+    tez::generate_c(ast, out, pool);
+    return out.str();
+}
+
+}
+
+TEST(C_Codegen, Parallel_Output_Matches_Serial) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Ast ast;
+    for(int f = 0; f < 3; ++f) {
+        std::string input = "struct S" + std::to_string(f) + " { x: Int; }\n";
+        for(int i = 0; i < 2000; ++i) {
+            input += "func f" + std::to_string(i) + "(a: Int) -> Int {\n"
+                    "    if a > " + std::to_string(i) + " { return a * 2; }\n"
+                    "    return a + 1;\n"
+                    "}\n";
+        }
+        ast.push_back(parse(files, diagnostics, input));
+    }
+    ASSERT_EQ(diagnostics.error_count(), 0);
+    ast.emplace_back();     // Empty file.
+
+    std::string expected;
+    for(const auto& file : ast) {
+        expected += tez::generate_c(file) + "\n";
+    }
+    ASSERT_EQ(generate(ast, 1), expected);
+    ASSERT_EQ(generate(ast, 4), expected);
+}
+
+TEST(C_Codegen, Shards_Are_Balanced) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Ast ast;
+    std::string input = "struct S { x: Int; }\n"
+            "var global: Int = 1;\n";
+    // Function i has i statements.
+    for(int i = 1; i <= 100; ++i) {
+        input += "func f" + std::to_string(i) + "() -> Int {\n";
+        for(int j = 0; j < i; ++j) {
+            input += "    global = global + 1;\n";
+        }
+        input += "    return global;\n}\n";
+    }
+    ast.push_back(parse(files, diagnostics, input));
+    ASSERT_EQ(diagnostics.error_count(), 0);
+
+    const auto& statements_of_file = ast[0].statements;
+    const auto position = [&](const tez::Ast_Node* node) {
+        return std::find(statements_of_file.begin(), statements_of_file.end(), node)
+                - statements_of_file.begin();
+    };
+    const auto shards = tez::split_c_shards(ast, 4);
+    ASSERT_EQ(shards.size(), 4);
+    std::size_t statements = 0;
+    std::size_t smallest = SIZE_MAX;
+    std::size_t largest = 0;
+    for(const auto& shard : shards) {
+        statements += shard.size();
+        tez::C_Writer out;
+        tez::generate_c_definitions(shard, out);
+        smallest = std::min(smallest, out.size());
+        largest = std::max(largest, out.size());
+        // Source order is kept.
+        for(std::size_t i = 1; i < shard.size(); ++i) {
+            ASSERT_LT(position(shard[i - 1]), position(shard[i]));
+        }
+    }
+    ASSERT_EQ(statements, 101);     // Struct stays in header.
+    ASSERT_LT(largest - smallest, largest / 20);
+
+    const auto per_file = tez::split_c_shards_per_file(ast);
+    ASSERT_EQ(per_file.size(), 1);
+    ASSERT_EQ(per_file[0].size(), 101);
+}
+
+TEST(C_Codegen, Declarations) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Ast ast;
+    ast.push_back(parse(files, diagnostics,
+            "func add(a: Int, b: Int) -> Int { return a + b; }\n"
+            "let limit: Int = 10;\n"));
+    ast.push_back(parse(files, diagnostics,
+            "struct Point { x: Int; y: Int; }\n"));
+    ASSERT_EQ(diagnostics.error_count(), 0);
+
+    tez::C_Writer out;
+    tez::generate_c_declarations(ast, out);
+    const auto expected = "#pragma once\n" + std::string{tez::C_PRELUDE}
+            + "typedef struct {\n"
+            "\tInt x;\n"
+            "\tInt y;\n"
+            "} Point;\n"
+            "Int add(Int a, Int b);\n"
+            "extern const Int limit;\n";
+    ASSERT_EQ(out.str(), expected);
+}
+
+TEST(C_Codegen, Unity) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Ast ast;
+    ast.push_back(parse(files, diagnostics,
+            "func main() -> Int { return twice(limit); }\n"));
+    ast.push_back(parse(files, diagnostics,
+            "struct Point { x: Int; }\n"
+            "let limit: Int = 10;\n"
+            "func twice(a: Int) -> Int { return a * 2; }\n"
+            "func api() -> Void {}\n"));
+    ASSERT_EQ(diagnostics.error_count(), 0);
+
+    tez::C_Writer out;
+    tez::generate_c_unity(ast, {tez::intern("api")}, out);
+    const auto expected = std::string{tez::C_PRELUDE}
+            + "typedef struct {\n"
+            "\tInt x;\n"
+            "} Point;\n"
+            "Int main();\n"
+            "static Int twice(Int a);\n"
+            "Void api();\n"
+            "static const Int limit = 10;\n"
+            "\n"
+            "Int main() {\n"
+            "\treturn twice(limit);\n"
+            "}\n"
+            "\n"
+            "static Int twice(Int a) {\n"
+            "\treturn a * 2;\n"
+            "}\n"
+            "Void api() {\n"
+            "}\n";
+    ASSERT_EQ(out.str(), expected);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+#include "codegen/c_writer.h"
+
+TEST(C_Writer, Formatting) {
+    tez::C_Writer out;
+    out.write("x = ").write_integer(-42).write(", ").write_real(3.25)
+            .write(';');
+    out.indent();
+    out.write('\n').write_indent().write(tez::intern("name"));
+
+    ASSERT_EQ(out.str(), "x = -42, " + std::to_string(3.25) + ";\n\tname");
+    ASSERT_EQ(out.size(), out.str().size());
+}
+
+TEST(C_Writer, Deep_Indentation) {
+    tez::C_Writer out;
+    for(int i = 0; i < 100; ++i) {
+        out.indent();
+    }
+    out.write_indent();
+    out.dedent();
+    out.write_indent();
+
+    ASSERT_EQ(out.str(), std::string(100, '\t') + std::string(99, '\t'));
+}
+
+TEST(C_Writer, Flushes_To_File) {
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    const auto fd = fileno(file);
+    const std::string line(1000, 'a');
+    std::size_t written = 0;
+    {
+        tez::C_Writer out{fd};
+        while(written <= 2 * tez::C_Writer::FLUSH_SIZE) {
+            out.write(line);
+            written += line.size();
+            ASSERT_LT(out.str().size(), tez::C_Writer::FLUSH_SIZE);
+        }
+        ASSERT_EQ(out.size(), written);
+    }
+    ASSERT_EQ(static_cast<std::size_t>(::lseek(fd, 0, SEEK_END)), written);
+    std::fclose(file);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "syntax/char_scan.h"
+
+namespace {
+
+// All implementations supported by this CPU must give the same answers.
+std::vector<tez::Scan_Isa> supported_isas() {
+    std::vector<tez::Scan_Isa> isas{tez::Scan_Isa::SCALAR};
+    if(tez::best_scan_isa() != tez::Scan_Isa::SCALAR) {
+        isas.push_back(tez::Scan_Isa::SSE2);
+    }
+    if(tez::best_scan_isa() == tez::Scan_Isa::AVX2) {
+        isas.push_back(tez::Scan_Isa::AVX2);
+    }
+    return isas;
+}
+
+std::string random_text(std::size_t size, const std::string& alphabet,
+        unsigned seed) {
+    std::mt19937 rng{seed};
+    std::string text(size, ' ');
+    for(auto& c : text) {
+        c = alphabet[rng() % alphabet.size()];
+    }
+    return text;
+}
+
+}
+
+TEST(Char_Scan, Character_Classes) {
+    ASSERT_TRUE(tez::is_whitespace('\v'));
+    ASSERT_FALSE(tez::is_whitespace('\0'));
+    ASSERT_TRUE(tez::is_identifier_start('_'));
+    ASSERT_FALSE(tez::is_identifier_start('7'));
+    ASSERT_TRUE(tez::is_identifier('7'));
+    ASSERT_TRUE(tez::is_punct('@'));
+    ASSERT_FALSE(tez::is_punct('_'));
+    ASSERT_FALSE(tez::is_identifier(static_cast<char>(0xC3)));
+}
+
+TEST(Char_Scan, Implementations_Agree) {
+    const std::string alphabet = " \t\n\r_azAZ09*/\"\\{@`[\x80\xff";
+    for(unsigned seed = 0; seed < 200; ++seed) {
+        // Padded like Source_Buffer, skip functions need NUL sentinel.
+        const auto text = random_text(seed % 97, alphabet, seed)
+                + std::string(tez::SCAN_OVERREAD + 1, '\0');
+        const char* begin = text.data();
+        const char* end = begin + text.size() - tez::SCAN_OVERREAD - 1;
+        const auto& reference = tez::scan_functions(tez::Scan_Isa::SCALAR);
+        for(auto isa : supported_isas()) {
+            const auto& f = tez::scan_functions(isa);
+            for(const char* p = begin; p < end; ++p) {
+                ASSERT_EQ(f.skip_whitespace(p), reference.skip_whitespace(p));
+                ASSERT_EQ(f.skip_identifier(p), reference.skip_identifier(p));
+                ASSERT_EQ(f.find_either(p, end, '*', '/'),
+                        reference.find_either(p, end, '*', '/'));
+                const char* last = nullptr;
+                const char* reference_last = nullptr;
+                ASSERT_EQ(f.count_newlines(p, end, last),
+                        reference.count_newlines(p, end, reference_last));
+                ASSERT_EQ(last, reference_last);
+            }
+        }
+    }
+}
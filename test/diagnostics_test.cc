@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "syntax/diagnostics.h"
+#include "syntax/lexer.h"
+#include "syntax/parser.h"
+
+TEST(Diagnostics, Sorted_By_Location) {
+    tez::File_Table files;
+    const auto first = files.add("first", "a\nbc");
+    const auto second = files.add("second", "x");
+    tez::Diagnostics diagnostics;
+    diagnostics.report(tez::Severity::ERROR,
+            tez::Diagnostic_Id::UNKNOWN_OPERATOR, second, 0, '@');
+    diagnostics.report(tez::Severity::ERROR,
+            tez::Diagnostic_Id::UNEXPECTED_CHARACTER, first, 3, '\0');
+    diagnostics.report(tez::Severity::ERROR,
+            tez::Diagnostic_Id::EXPECTED_TOKEN, first, 0,
+            static_cast<std::uint32_t>(tez::Token_Type::SEMICOLON),
+            static_cast<std::uint32_t>(tez::Token_Type::END_OF_FILE));
+    std::ostringstream out;
+    diagnostics.flush(files, out);
+
+    ASSERT_EQ(diagnostics.error_count(), 3);
+    ASSERT_EQ(out.str(),
+            "first:1:1: error: Expected "
+                    + tez::to_string(tez::Token_Type::SEMICOLON) + ", got "
+                    + tez::to_string(tez::Token_Type::END_OF_FILE) + ".\n"
+            "first:2:2: error: Unexpected character '\\x00'.\n"
+            "second:1:1: error: Unknown operator '@'.\n");
+}
+
+TEST(Diagnostics, Error_Limit) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics{2};
+    diagnostics.report(tez::Severity::WARNING, "Not counted");
+
+    ASSERT_TRUE(diagnostics.report(tez::Severity::ERROR, "First"));
+    ASSERT_FALSE(diagnostics.limit_reached());
+    ASSERT_TRUE(diagnostics.report(tez::Severity::ERROR, "Second"));
+    ASSERT_TRUE(diagnostics.limit_reached());
+    ASSERT_FALSE(diagnostics.report(tez::Severity::ERROR, "Third"));
+    ASSERT_EQ(diagnostics.error_count(), 2);
+
+    std::ostringstream out;
+    diagnostics.flush(files, out);
+    ASSERT_EQ(out.str(),
+            "warning: Not counted.\n"
+            "error: First.\n"
+            "error: Second.\n"
+            "note: Too many errors, stopping now.\n");
+}
+
+TEST(Diagnostics, No_File_Is_Reserved) {
+    tez::File_Table files;
+    for(std::size_t i = 0; i < tez::NO_FILE; ++i) {
+        files.add("f", "");
+    }
+    ASSERT_THROW(files.add("f", ""), std::length_error);
+
+    tez::Diagnostics diagnostics;
+    diagnostics.report(tez::Severity::ERROR,
+            tez::Diagnostic_Id::UNEXPECTED_END_OF_FILE, tez::NO_FILE - 1, 0);
+    std::ostringstream out;
+    diagnostics.flush(files, out);
+    ASSERT_EQ(out.str(), "f:1:1: error: Unexpected end of file.\n");
+}
+
+TEST(Diagnostics, Limit_Stops_Lexer_And_Parser) {
+    std::string input;
+    for(int i = 0; i < 1000; ++i) {
+        input += "let a = $;\n";
+    }
+    tez::File_Table files;
+    tez::Diagnostics diagnostics{5};
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    tez::Parser parser{lexer, files, diagnostics};
+    const auto file_unit = parser.parse();
+
+    ASSERT_TRUE(diagnostics.limit_reached());
+    ASSERT_EQ(diagnostics.error_count(), 5);
+    ASSERT_LT(file_unit.statements.size(), 10);
+}
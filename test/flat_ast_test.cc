@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "codegen/c_codegen.h"
+#include "syntax/flat_ast.h"
+#include "syntax/lexer.h"
+#include "syntax/parser.h"
+
+namespace {
+
+const std::string INPUT =
+        "struct Point { x: Int; y: Int; data: [Int, 4]; }\n"
+        "enum Color { RED, GREEN = 5, BLUE }\n"
+        "union Value { i: Int64; d: Double; }\n"
+        "func add(a: Int, b: Int) -> Int { return a + b; }\n"
+        "func compute(p: ^Point, n: var Int) -> Int {\n"
+        "    var total: Int = 0;\n"
+        "    var arr: [Int, 3] = [1, 2, 3];\n"
+        "    if total == 0 { total = add(1, 2); }\n"
+        "    else if total > 5 { total += 3; } else { total = -total; }\n"
+        "    while total < 10 { if !(total != 3) { break; } }\n"
+        "    for var i: Int = 0; i < 10; i += 1 { continue; }\n"
+        "    do { total = total << 1; } while total < 100;\n"
+        "    var d: Double = total as Double;\n"
+        "    var s: ^Char = \"text\";\n"
+        "    var r: Double = 3.25;\n"
+        "    var q: ^Point = new Point;\n"
+        "    free q;\n"
+        "    return arr[1] + p.x & 255 | 1 ^ 2;\n"
+        "}\n";
+
+struct Parsed {
+    tez::File_Table files;
+    tez::Ast_File   ast;
+};
+
+std::unique_ptr<Parsed> parse(const std::string& input) {
+    auto parsed = std::make_unique<Parsed>();
+    tez::Diagnostics diagnostics;
+    const auto file = parsed->files.add("test", input);
+    tez::Lexer lexer{parsed->files, file, diagnostics};
+    tez::Parser parser{lexer, parsed->files, diagnostics};
+    parsed->ast = parser.parse();
+    EXPECT_FALSE(parser.errors_reported());
+    return parsed;
+}
+
+}
+
+TEST(Flat_Ast, Same_C_Code) {
+    const auto parsed = parse(INPUT);
+    const auto flat = tez::flatten(parsed->ast);
+
+    ASSERT_EQ(flat[flat.root].type, tez::Ast_Node_Type::FILE);
+    ASSERT_EQ(flat.root, flat.nodes.size() - 1);
+    ASSERT_EQ(tez::generate_c(flat),
+            tez::generate_c(parsed->ast));
+}
+
+TEST(Flat_Ast, Children_Before_Parents) {
+    const auto parsed = parse(INPUT);
+    const auto flat = tez::flatten(parsed->ast);
+
+    for(tez::Node_Index i = 0; i < flat.nodes.size(); ++i) {
+        const auto& node = flat[i];
+        if(node.type == tez::Ast_Node_Type::BINARY_OPERATION) {
+            ASSERT_LT(node.data[0], i);
+            ASSERT_LT(node.data[1], i);
+        }
+    }
+}
+
+TEST(Flat_Ast, Serialization) {
+    const auto parsed = parse(INPUT);
+    const auto flat = tez::flatten(parsed->ast);
+    const auto bytes = flat.serialize();
+    const auto copy = tez::Flat_Ast::deserialize(bytes);
+
+    ASSERT_EQ(copy.nodes.size(), flat.nodes.size());
+    ASSERT_EQ(copy.chars, flat.chars);
+    ASSERT_EQ(tez::generate_c(copy),
+            tez::generate_c(flat));
+    ASSERT_THROW(tez::Flat_Ast::deserialize(bytes.substr(0, bytes.size() - 1)),
+            std::invalid_argument);
+}
+
+TEST(Flat_Ast, Corrupted_Header) {
+    const auto parsed = parse(INPUT);
+    const auto bytes = tez::flatten(parsed->ast).serialize();
+    // Header is five 64-bit sizes: nodes, lists, texts, chars and root.
+    const auto corrupted = [&bytes](std::size_t field, std::uint64_t value) {
+        auto copy = bytes;
+        std::memcpy(copy.data() + field * sizeof(value), &value, sizeof(value));
+        return copy;
+    };
+    // Sum of table sizes wraps around to the real size.
+    const auto wrapped = std::uint64_t{1} << 60;
+    std::uint64_t nodes;
+    std::memcpy(&nodes, bytes.data(), sizeof(nodes));
+
+    ASSERT_THROW(tez::Flat_Ast::deserialize(corrupted(0, nodes + wrapped)),
+            std::invalid_argument);
+    ASSERT_THROW(tez::Flat_Ast::deserialize(corrupted(3, UINT64_MAX)),
+            std::invalid_argument);
+    ASSERT_THROW(tez::Flat_Ast::deserialize(corrupted(4, nodes)),
+            std::invalid_argument);
+    ASSERT_NO_THROW(tez::Flat_Ast::deserialize(corrupted(4, nodes - 1)));
+}
+
+TEST(Flat_Ast, Corrupted_Nodes) {
+    const auto parsed = parse(INPUT);
+    const auto flat = tez::flatten(parsed->ast);
+    const auto find = [&flat](tez::Ast_Node_Type type) {
+        for(std::size_t i = 0; i < flat.nodes.size(); ++i) {
+            if(flat.nodes[i].type == type) {
+                return i;
+            }
+        }
+        return flat.nodes.size();
+    };
+    const auto binary = find(tez::Ast_Node_Type::BINARY_OPERATION);
+    const auto identifier = find(tez::Ast_Node_Type::IDENTIFIER);
+    const auto function = find(tez::Ast_Node_Type::FUNCTION_DECLARATION);
+    ASSERT_LT(binary, flat.nodes.size());
+    ASSERT_LT(identifier, flat.nodes.size());
+    ASSERT_LT(function, flat.nodes.size());
+    const auto rejected = [&flat](auto corrupt) {
+        auto copy = flat;
+        corrupt(copy);
+        EXPECT_THROW(tez::Flat_Ast::deserialize(copy.serialize()),
+                std::invalid_argument);
+    };
+
+    ASSERT_NO_THROW(tez::Flat_Ast::deserialize(flat.serialize()));
+    // Child after its parent, which could make a cycle.
+    rejected([&](tez::Flat_Ast& ast) { ast.nodes[binary].data[1] = binary; });
+    rejected([&](tez::Flat_Ast& ast) { ast.nodes[binary].flags = 200; });
+    rejected([&](tez::Flat_Ast& ast) {
+        ast.nodes[identifier].data[0] = static_cast<std::uint32_t>(
+                ast.texts.size());
+    });
+    rejected([](tez::Flat_Ast& ast) { ast.texts.back().length = 1000; });
+    rejected([](tez::Flat_Ast& ast) { ast.nodes[ast.root].data[1] += 1; });
+    rejected([&](tez::Flat_Ast& ast) { ast.nodes[function].data[2] = 2; });
+    // Parameter that isn't variable declaration.
+    rejected([&](tez::Flat_Ast& ast) {
+        ast.lists[ast.nodes[function].data[1] + 3] = identifier;
+    });
+    rejected([](tez::Flat_Ast& ast) {
+        ast.nodes[0].type = static_cast<tez::Ast_Node_Type>(200);
+    });
+}
+
+TEST(Flat_Ast, Deep_Nesting) {
+    constexpr std::size_t DEPTH = 200'000;
+    const auto parsed = parse("func f() -> Int { return "
+            + std::string(DEPTH, '(') + "1" + std::string(DEPTH, ')') + "; }");
+    const auto flat = tez::flatten(parsed->ast);
+
+    ASSERT_GT(flat.nodes.size(), DEPTH);
+    ASSERT_EQ(tez::generate_c(flat),
+            tez::generate_c(parsed->ast));
+}
@@ -1,10 +1,13 @@
 #include <gtest/gtest.h>
 
 #include "syntax/lexer.h"
+#include "syntax/token_buffer.h"
 
 TEST(Lexer, Whitespaces) {
     std::string input = " \t\n\r\v\f";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
     
     // All whitespaces should be skipped.
@@ -13,7 +16,9 @@ TEST(Lexer, Whitespaces) {
 
 TEST(Lexer, Braces_And_Parentheses) {
     std::string input = "({)}";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
 
     ASSERT_EQ(output.at(0).type, tez::Token_Type::L_PAREN);
@@ -24,7 +29,9 @@ TEST(Lexer, Braces_And_Parentheses) {
 
 TEST(Lexer, Operators) {
     std::string input = "-> == != >=";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
 
     ASSERT_EQ(output.at(0).type, tez::Token_Type::ARROW);
@@ -35,36 +42,44 @@ TEST(Lexer, Operators) {
 
 TEST(Lexer, Integers) {
     std::string input = "17 43 65";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
     
-    ASSERT_STREQ(output.at(0).value.c_str(), "17");
-    ASSERT_STREQ(output.at(1).value.c_str(), "43");
-    ASSERT_STREQ(output.at(2).value.c_str(), "65");
+    ASSERT_EQ(files.lexeme(output.at(0)), "17");
+    ASSERT_EQ(files.lexeme(output.at(1)), "43");
+    ASSERT_EQ(files.lexeme(output.at(2)), "65");
 }
 
 TEST(Lexer, Real_numbers) {
     std::string input = "51.534 823.1 4.54767";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
-    ASSERT_STREQ(output.at(0).value.c_str(), "51.534");
-    ASSERT_STREQ(output.at(1).value.c_str(), "823.1");
-    ASSERT_STREQ(output.at(2).value.c_str(), "4.54767");
+    ASSERT_EQ(files.lexeme(output.at(0)), "51.534");
+    ASSERT_EQ(files.lexeme(output.at(1)), "823.1");
+    ASSERT_EQ(files.lexeme(output.at(2)), "4.54767");
 }
 
 TEST(Lexer, Identifiers) {
     std::string input = "asdf compiler lexer";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
     
-    ASSERT_STREQ(output.at(0).value.c_str(), "asdf");
-    ASSERT_STREQ(output.at(1).value.c_str(), "compiler");
-    ASSERT_STREQ(output.at(2).value.c_str(), "lexer");
+    ASSERT_EQ(files.lexeme(output.at(0)), "asdf");
+    ASSERT_EQ(files.lexeme(output.at(1)), "compiler");
+    ASSERT_EQ(files.lexeme(output.at(2)), "lexer");
 }
 
 TEST(Lexer, Keywords) {
     std::string input = "func break namespace struct";
-    tez::Lexer lexer{input, true};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
     auto output = lexer.tokenize();
     
     ASSERT_EQ(output.size(), 4);
@@ -74,3 +89,120 @@ TEST(Lexer, Keywords) {
     ASSERT_EQ(output.at(3).type, tez::Token_Type::KW_STRUCT);
 }
 
+
+TEST(Lexer, Comment_Without_Trailing_Newline) {
+    std::string input = "func // comment";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    auto output = lexer.tokenize();
+
+    ASSERT_FALSE(lexer.errors_reported());
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_EQ(output.at(0).type, tez::Token_Type::KW_FUNC);
+}
+
+TEST(Lexer, Strings_And_Characters) {
+    std::string input = "\"a \\\"b\\\"\" 'c' '\\n'";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    auto output = lexer.tokenize();
+
+    ASSERT_EQ(output.size(), 3);
+    ASSERT_EQ(output.at(0).type, tez::Token_Type::STRING);
+    ASSERT_EQ(files.lexeme(output.at(0)), "a \\\"b\\\"");
+    ASSERT_EQ(files.lexeme(output.at(1)), "c");
+    ASSERT_EQ(files.lexeme(output.at(2)), "\\n");
+}
+
+TEST(Lexer, Longest_Operator_Match) {
+    std::string input = "<<= << <= < >>= >> :: : -= && &= |";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    auto output = lexer.tokenize();
+
+    ASSERT_EQ(output.size(), 12);
+    ASSERT_EQ(output.at(0).type, tez::Token_Type::LEFT_SHIFT_EQUALS);
+    ASSERT_EQ(output.at(1).type, tez::Token_Type::BITWISE_SHIFT_LEFT);
+    ASSERT_EQ(output.at(2).type, tez::Token_Type::LESS_EQUALS);
+    ASSERT_EQ(output.at(3).type, tez::Token_Type::LESS);
+    ASSERT_EQ(output.at(4).type, tez::Token_Type::RIGHT_SHIFT_EQUALS);
+    ASSERT_EQ(output.at(5).type, tez::Token_Type::BITWISE_SHIFT_RIGHT);
+    ASSERT_EQ(output.at(6).type, tez::Token_Type::SCOPE_RESOLUTION);
+    ASSERT_EQ(output.at(7).type, tez::Token_Type::COLON);
+    ASSERT_EQ(output.at(8).type, tez::Token_Type::MINUS_EQUALS);
+    ASSERT_EQ(output.at(9).type, tez::Token_Type::LOGICAL_AND);
+    ASSERT_EQ(output.at(10).type, tez::Token_Type::AND_EQUALS);
+    ASSERT_EQ(output.at(11).type, tez::Token_Type::BITWISE_OR);
+}
+
+TEST(Lexer, Nested_Comments) {
+    std::string input = "/* a /* b */ c */ func /* d\n*/ return";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    auto output = lexer.tokenize();
+
+    ASSERT_FALSE(lexer.errors_reported());
+    ASSERT_EQ(output.size(), 2);
+    ASSERT_EQ(output.at(0).type, tez::Token_Type::KW_FUNC);
+    ASSERT_EQ(output.at(1).type, tez::Token_Type::KW_RETURN);
+    ASSERT_EQ(files.location(output.at(1)).line, 2);
+    ASSERT_EQ(files.location(output.at(1)).column, 4);
+}
+
+TEST(Lexer, Location_After_Edit) {
+    tez::File_Table files;
+    const auto file = files.add("test", "a\nb");
+    const auto& source_file = files.file(file);
+    ASSERT_EQ(files.location(file, 2).line, 2);
+
+    files.edit(file, {0, 0, "x\n\n"});
+    ASSERT_EQ(source_file.buffer.view(), "x\n\na\nb");
+    ASSERT_EQ(files.location(file, 2).line, 2);
+    ASSERT_EQ(files.location(file, 5).line, 4);
+}
+
+TEST(Lexer, Unterminated_Comment) {
+    std::string input = "func /* /* */";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    lexer.tokenize();
+
+    ASSERT_TRUE(lexer.errors_reported());
+}
+
+TEST(Lexer, Stray_Nul_Character) {
+    std::string input{"func \0 return", 13};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    auto output = lexer.tokenize();
+
+    ASSERT_TRUE(lexer.errors_reported());
+    ASSERT_EQ(output.size(), 2);
+    ASSERT_EQ(output.at(1).type, tez::Token_Type::KW_RETURN);
+}
+
+TEST(Lexer, Compact_Token_Buffer) {
+    std::string input = "let name = \"text\"; func name() -> i32 { return 42; }";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    const auto file = files.add("test", input);
+    tez::Lexer lexer{files, file, diagnostics};
+    const auto expected = lexer.tokenize();
+    tez::Lexer compact_lexer{files, file, diagnostics};
+    const tez::Token_Buffer output{compact_lexer};
+
+    ASSERT_EQ(output.size(), expected.size());
+    for(std::size_t i = 0; i < output.size(); ++i) {
+        ASSERT_EQ(output.type(i), expected.at(i).type);
+        ASSERT_EQ(output[i].offset, expected.at(i).offset);
+        ASSERT_EQ(output[i].length, expected.at(i).length);
+        ASSERT_EQ(output[i].atom, expected.at(i).atom);
+    }
+    ASSERT_LT(output.memory_usage(), expected.size() * sizeof(tez::Token));
+}
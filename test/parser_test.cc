@@ -1,15 +1,253 @@
 #include <gtest/gtest.h>
 
+#include "codegen/c_codegen.h"
 #include "syntax/lexer.h"
 #include "syntax/parser.h"
+#include "syntax/token_buffer.h"
+
+namespace {
+
+// Expression with every operation in parentheses, to check tree shape.
+std::string parenthesize(const tez::Ast_Node* node) {
+    using tez::Ast_Node_Type;
+    switch(node->node_type) {
+    case Ast_Node_Type::BINARY_OPERATION: {
+        const auto op = static_cast<const tez::Ast_Binary_Operation*>(node);
+        return "(" + parenthesize(op->left) + " " + std::string{tez::spelling(op->operat)}
+                + " " + parenthesize(op->right) + ")";
+    }
+    case Ast_Node_Type::UNARY_OPERATION: {
+        const auto op = static_cast<const tez::Ast_Unary_Operation*>(node);
+        return "(" + std::string{tez::spelling(op->operat)} + parenthesize(op->left) + ")";
+    }
+    case Ast_Node_Type::CAST: {
+        const auto cast = static_cast<const tez::Ast_Cast*>(node);
+        return "(" + parenthesize(cast->expr) + " as "
+                + parenthesize(cast->to) + ")";
+    }
+    case Ast_Node_Type::MEMBER_ACCESS: {
+        const auto ma = static_cast<const tez::Ast_Member_Access*>(node);
+        return "(" + parenthesize(ma->left) + "." + parenthesize(ma->right)
+                + ")";
+    }
+    case Ast_Node_Type::PTR_DEREFERENCE:
+        return "(^" + parenthesize(
+                static_cast<const tez::Ast_Ptr_Dereference*>(node)->expr) + ")";
+    default: {
+        return tez::generate_c(*node);
+    }
+    }
+}
+
+std::string parse_expression(const std::string& input) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input + ";"), diagnostics};
+    tez::Parser parser{lexer, files, diagnostics};
+    auto file_unit = parser.parse();
+    if(parser.errors_reported() || file_unit.statements.size() != 1) {
+        return "<error>";
+    }
+    return parenthesize(file_unit.statements.at(0));
+}
+
+const std::string REPARSE_INPUT =
+        "func a() -> Int { return 1; }\n"
+        "// Comment.\n"
+        "func b() -> Int { return 2; }\n"
+        "struct C { x: Int; }\n";
+
+// Edit source, reparse it and check result matches parsing edited source from
+// scratch. Statements parsed before edit are stored to original.
+tez::Ast_File reparse(const std::string& input, const tez::Text_Edit& edit,
+        std::vector<tez::Ast_Node_Ptr>* original = nullptr) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    const auto file = files.add("test", input);
+    tez::Lexer lexer{files, file, diagnostics};
+    auto file_unit = tez::Parser{lexer, files, diagnostics}.parse();
+    if(original != nullptr) {
+        *original = file_unit.statements;
+    }
+    files.edit(file, edit);
+    EXPECT_TRUE(tez::Parser::reparse(file_unit, file, edit, files,
+            diagnostics));
+
+    tez::Lexer fresh_lexer{files, file, diagnostics};
+    const auto fresh = tez::Parser{fresh_lexer, files, diagnostics}.parse();
+    EXPECT_EQ(tez::generate_c(file_unit),
+            tez::generate_c(fresh));
+    EXPECT_EQ(file_unit.ranges.size(), fresh.ranges.size());
+    for(std::size_t i = 0; i < fresh.ranges.size(); ++i) {
+        EXPECT_EQ(file_unit.ranges[i].begin, fresh.ranges[i].begin);
+        EXPECT_EQ(file_unit.ranges[i].end, fresh.ranges[i].end);
+    }
+    return file_unit;
+}
+
+}
 
 TEST(Parser, Namespaces) {
     std::string input = "namespace qwer {}";
-    tez::Lexer lexer{input, true};
-    tez::Parser parser{lexer.tokenize()};
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    tez::Parser parser{lexer, files, diagnostics};
     auto file_unit = parser.parse();
 
     ASSERT_EQ(file_unit.statements.size(), 1);
     ASSERT_EQ(file_unit.statements.back()->node_type, tez::Ast_Node_Type::NAMESPACE);
 }
 
+
+TEST(Parser, Tokenized_Input) {
+    std::string input = "func main() -> Int { return 0; } struct A { x: Int; }";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    const auto tokens = lexer.tokenize();
+    tez::Parser parser{tokens, files, diagnostics};
+    auto file_unit = parser.parse();
+
+    ASSERT_FALSE(parser.errors_reported());
+    ASSERT_EQ(file_unit.statements.size(), 2);
+    ASSERT_EQ(file_unit.statements.at(0)->node_type, tez::Ast_Node_Type::FUNCTION_DECLARATION);
+    ASSERT_EQ(file_unit.statements.at(1)->node_type, tez::Ast_Node_Type::STRUCT);
+}
+
+TEST(Parser, Compact_Tokens) {
+    std::string input = "func add(a: Int, b: Int) -> Int { return a + b * 2; }";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    const tez::Token_Buffer tokens{lexer};
+    tez::Parser parser{tokens, files, diagnostics};
+    auto file_unit = parser.parse();
+
+    ASSERT_FALSE(parser.errors_reported());
+    ASSERT_EQ(file_unit.statements.size(), 1);
+    ASSERT_EQ(file_unit.statements.at(0)->node_type, tez::Ast_Node_Type::FUNCTION_DECLARATION);
+}
+
+TEST(Parser, Missing_Closing_Brace) {
+    std::string input = "func main() -> Int { return 0;";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    tez::Parser parser{lexer, files, diagnostics};
+    parser.parse();
+
+    ASSERT_TRUE(parser.errors_reported());
+}
+
+TEST(Parser, Error_At_First_Token) {
+    std::string input = "= 1; func main() -> Int { return 0; }";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    const tez::Token_Buffer tokens{lexer};
+    tez::Parser parser{tokens, files, diagnostics};
+    parser.parse();
+
+    ASSERT_TRUE(parser.errors_reported());
+}
+
+TEST(Parser, Operator_Precedence) {
+    ASSERT_EQ(parse_expression("a + b * c"), "(a + (b * c))");
+    ASSERT_EQ(parse_expression("a * b + c"), "((a * b) + c)");
+    ASSERT_EQ(parse_expression("a << b + c < d == e"), "(((a << (b + c)) < d) == e)");
+    ASSERT_EQ(parse_expression("a | b ^ c & d"), "(a | (b ^ (c & d)))");
+    ASSERT_EQ(parse_expression("a || b && c"), "(a || (b && c))");
+    ASSERT_EQ(parse_expression("-a as T * b"), "(((-a) as T) * b)");
+    ASSERT_EQ(parse_expression("!a == b"), "((!a) == b)");
+    ASSERT_EQ(parse_expression("x = a + b == c"), "(x = ((a + b) == c))");
+}
+
+TEST(Parser, Operator_Associativity) {
+    ASSERT_EQ(parse_expression("a - b - c"), "((a - b) - c)");
+    ASSERT_EQ(parse_expression("a / b * c % d"), "(((a / b) * c) % d)");
+    ASSERT_EQ(parse_expression("a = b += c"), "(a = (b += c))");
+    ASSERT_EQ(parse_expression("a.b.c"), "((a.b).c)");
+    ASSERT_EQ(parse_expression("a->b.c"), "(((^a).b).c)");
+}
+
+TEST(Parser, Reparse_Keeps_Untouched_Statements) {
+    const auto body = static_cast<std::uint32_t>(REPARSE_INPUT.find("2;"));
+    std::vector<tez::Ast_Node_Ptr> original;
+    const auto file_unit = reparse(REPARSE_INPUT, {body, 1, "40 + 2"},
+            &original);
+
+    ASSERT_EQ(file_unit.statements.size(), 3);
+    ASSERT_EQ(file_unit.statements[0], original[0]);
+    ASSERT_NE(file_unit.statements[1], original[1]);
+    ASSERT_EQ(file_unit.statements[2], original[2]);
+}
+
+TEST(Parser, Reparse_Edits) {
+    const auto input_size = static_cast<std::uint32_t>(REPARSE_INPUT.size());
+    const auto comment = static_cast<std::uint32_t>(REPARSE_INPUT.find("//"));
+    const auto second = static_cast<std::uint32_t>(REPARSE_INPUT.find("func b"));
+    // Insertions at both ends.
+    ASSERT_EQ(reparse(REPARSE_INPUT, {0, 0, "struct D { y: Int; } "})
+            .statements.size(), 4);
+    ASSERT_EQ(reparse(REPARSE_INPUT, {input_size, 0, "func e() {}"})
+            .statements.size(), 4);
+    // Whitespace and comments only shift statements.
+    ASSERT_EQ(reparse(REPARSE_INPUT, {0, 0, "\n\n"}).statements.size(), 3);
+    ASSERT_EQ(reparse(REPARSE_INPUT, {comment, 11, ""}).statements.size(), 3);
+    // Opened comment swallows everything after it.
+    ASSERT_EQ(reparse(REPARSE_INPUT, {comment, 2, "/*"}).statements.size(), 1);
+    // Removed statement, and merged statements.
+    ASSERT_EQ(reparse(REPARSE_INPUT, {second, 30, ""}).statements.size(), 2);
+    ASSERT_EQ(reparse(REPARSE_INPUT, {second - 13, 13, ""})
+            .statements.size(), 3);
+    // Statement starting with literal begins at its quote.
+    ASSERT_EQ(reparse("\"s\"; " + REPARSE_INPUT, {2, 0, "t"})
+            .ranges.at(0).begin, 0);
+}
+
+TEST(Parser, Reparse_At_Error_Limit) {
+    tez::File_Table files;
+    tez::Diagnostics diagnostics{1};
+    const auto file = files.add("test", REPARSE_INPUT);
+    tez::Lexer lexer{files, file, diagnostics};
+    auto file_unit = tez::Parser{lexer, files, diagnostics}.parse();
+    const auto statements = file_unit.statements;
+    const auto ranges = file_unit.ranges.size();
+    // Error in the first statement stops reparse before anything after it.
+    const tez::Text_Edit edit{0, 0, "@ "};
+    files.edit(file, edit);
+
+    ASSERT_FALSE(tez::Parser::reparse(file_unit, file, edit, files,
+            diagnostics));
+    ASSERT_TRUE(diagnostics.limit_reached());
+    ASSERT_EQ(file_unit.statements, statements);
+    ASSERT_EQ(file_unit.ranges.size(), ranges);
+    // Limit was reached already.
+    ASSERT_FALSE(tez::Parser::reparse(file_unit, file, {0, 0, ""}, files,
+            diagnostics));
+    ASSERT_EQ(file_unit.statements, statements);
+}
+
+TEST(Parser, Deep_Nesting) {
+    const std::size_t depth = 200000;
+    std::string input = "func f(a: Int) -> Int {\nreturn "
+            + std::string(depth, '(') + "a" + std::string(depth, ')') + ";\n"
+            + "if a == 0 { return 0; }";
+    for(std::size_t i = 0; i < depth; ++i) {
+        input += " else if a == 1 { return 1; }";
+    }
+    input += "\nreturn a = a = a - -a - a;\n}";
+    tez::File_Table files;
+    tez::Diagnostics diagnostics;
+    tez::Lexer lexer{files, files.add("test", input), diagnostics};
+    tez::Parser parser{lexer, files, diagnostics};
+    const auto file_unit = parser.parse();
+    ASSERT_FALSE(parser.errors_reported());
+
+    const auto code = tez::generate_c(file_unit);
+    ASSERT_NE(code.find(std::string(depth, '(') + "a" + std::string(depth, ')')),
+            std::string::npos);
+    ASSERT_NE(code.find("} else if(a == 1) {"), std::string::npos);
+    ASSERT_NE(code.find("return a = a = a - -a - a;"), std::string::npos);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include <system_error>
+
+#include <sys/wait.h>
+
+#include "utils/process.h"
+
+TEST(Process, Exit_Status) {
+    tez::Process success{{"true"}};
+    tez::Process failure{{"sh", "-c", "exit 3"}};
+
+    ASSERT_EQ(success.wait(), 0);
+    ASSERT_EQ(failure.wait(), 3);
+    ASSERT_EQ(failure.wait(), 3);
+}
+
+TEST(Process, Killed) {
+    tez::Process process{{"sh", "-c", "kill -9 $$"}};
+
+    ASSERT_EQ(process.wait(), 128 + 9);
+}
+
+TEST(Process, Missing_Program) {
+    ASSERT_THROW(tez::Process{{"tez-no-such-program"}}, std::system_error);
+}
+
+TEST(Process, Not_Reaped) {
+    tez::Process process{{"true"}};
+    // Someone else reaps the child, so waitpid() in wait() fails.
+    ASSERT_GT(::waitpid(-1, nullptr, 0), 0);
+
+    ASSERT_EQ(process.wait(), tez::Process::FAILED);
+    ASSERT_EQ(process.wait(), tez::Process::FAILED);
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/thread_pool.h"
+
+TEST(Thread_Pool, Runs_All_Tasks) {
+    tez::Thread_Pool pool{4};
+    std::vector<int> results(1000);
+    for(int i = 0; i < 1000; ++i) {
+        pool.submit([&results, i] { results[i] = i * 2; });
+    }
+    pool.wait();
+
+    for(int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(results[i], i * 2);
+    }
+}
+
+TEST(Thread_Pool, Single_Thread_Runs_Inline) {
+    tez::Thread_Pool pool{1};
+    int counter = 0;
+    pool.submit([&counter] { ++counter; });
+
+    ASSERT_EQ(pool.size(), 0);
+    ASSERT_EQ(counter, 1);
+}
+
+TEST(Thread_Pool, Rethrows_Exception) {
+    tez::Thread_Pool pool{2};
+    std::atomic<int> finished{0};
+    pool.submit([] { throw std::runtime_error{"task failed"}; });
+    pool.submit([&finished] { ++finished; });
+
+    ASSERT_THROW(pool.wait(), std::runtime_error);
+    ASSERT_EQ(finished, 1);
+    pool.wait();    // Exception is reported only once.
+}